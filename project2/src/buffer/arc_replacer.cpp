@@ -0,0 +1,183 @@
+/**
+ * ARC implementation
+ */
+#include <algorithm>
+#include <cassert>
+
+#include "buffer/arc_replacer.h"
+
+namespace scudb {
+
+template <typename T>
+ARCReplacer<T>::ARCReplacer(size_t num_frames)
+    : num_frames_(num_frames), target_t1_(0), size_(0), values_(num_frames),
+      page_ids_(num_frames, INVALID_PAGE_ID), lists_(num_frames, NONE),
+      positions_(num_frames), in_use_(num_frames, false) {}
+
+template <typename T> ARCReplacer<T>::~ARCReplacer() {}
+
+/*
+ * Record an access and make the frame evictable.
+ * 1. page already resident: move it to the front of T2
+ * 2. page in a ghost list: adapt the T1 target, then put it in T2
+ * 3. otherwise it is new: put it in T1
+ */
+template <typename T> void ARCReplacer<T>::Insert(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  page_id_t page_id = PageIdOf(value);
+  assert(frame_id < num_frames_);
+  std::lock_guard<std::mutex> lck(latch_);
+
+  values_[frame_id] = value;
+  if (lists_[frame_id] != NONE) {
+    // the frame was freed by DeletePage and reloaded, forget the old page
+    auto &list = lists_[frame_id] == T1 ? t1_ : t2_;
+    list.erase(positions_[frame_id]);
+    if (page_ids_[frame_id] != page_id)
+      lists_[frame_id] = NONE;
+  }
+
+  if (lists_[frame_id] == NONE) {
+    auto ghost = ghosts_.find(page_id);
+    if (ghost == ghosts_.end()) {
+      t1_.push_front(frame_id);
+      lists_[frame_id] = T1;
+    } else {
+      if (ghost->second.first == T1) {
+        size_t delta = std::max<size_t>(1, b2_.size() / b1_.size());
+        target_t1_ = std::min(num_frames_, target_t1_ + delta);
+        b1_.erase(ghost->second.second);
+      } else {
+        size_t delta = std::max<size_t>(1, b1_.size() / b2_.size());
+        target_t1_ -= std::min(target_t1_, delta);
+        b2_.erase(ghost->second.second);
+      }
+      ghosts_.erase(ghost);
+      t2_.push_front(frame_id);
+      lists_[frame_id] = T2;
+    }
+    page_ids_[frame_id] = page_id;
+    TrimGhosts();
+  } else {
+    t2_.push_front(frame_id);
+    lists_[frame_id] = T2;
+  }
+  positions_[frame_id] = lists_[frame_id] == T1 ? t1_.begin() : t2_.begin();
+
+  if (!in_use_[frame_id]) {
+    in_use_[frame_id] = true;
+    size_++;
+  }
+}
+
+/*
+ * Evict from T1 while it is above its target, from T2 otherwise. Pinned
+ * frames stay in their lists, so fall back to the other list if the
+ * preferred one has nothing evictable.
+ */
+template <typename T> bool ARCReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lck(latch_);
+  if (size_ == 0)
+    return false;
+  ListType first = t1_.size() > target_t1_ ? T1 : T2;
+  ListType second = first == T1 ? T2 : T1;
+  bool found = EvictFrom(first, value) || EvictFrom(second, value);
+  assert(found);
+  return found;
+}
+
+/*
+ * Remove value from the candidates, e.g. because it was pinned again. The
+ * frame keeps its place in T1/T2 while it is resident.
+ * return true if it was evictable
+ */
+template <typename T> bool ARCReplacer<T>::Erase(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  std::lock_guard<std::mutex> lck(latch_);
+  if (!in_use_[frame_id])
+    return false;
+  in_use_[frame_id] = false;
+  size_--;
+  return true;
+}
+
+/*
+ * The frame leaves T1/T2 without becoming a ghost: its page was not evicted
+ * by the policy
+ */
+template <typename T> void ARCReplacer<T>::Reset(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  std::lock_guard<std::mutex> lck(latch_);
+  if (in_use_[frame_id]) {
+    in_use_[frame_id] = false;
+    size_--;
+  }
+  if (lists_[frame_id] != NONE) {
+    auto &list = lists_[frame_id] == T1 ? t1_ : t2_;
+    list.erase(positions_[frame_id]);
+    lists_[frame_id] = NONE;
+  }
+}
+
+template <typename T> size_t ARCReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return size_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetTargetRecencySize() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return target_t1_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetTargetFrequencySize() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return num_frames_ - target_t1_;
+}
+
+/*
+ * Caller must hold latch_. The evicted page becomes a ghost of the list it
+ * left.
+ */
+template <typename T> bool ARCReplacer<T>::EvictFrom(ListType list, T &value) {
+  auto &resident = list == T1 ? t1_ : t2_;
+  auto &ghost = list == T1 ? b1_ : b2_;
+  for (auto it = resident.rbegin(); it != resident.rend(); ++it) {
+    size_t frame_id = *it;
+    if (!in_use_[frame_id])
+      continue;
+    resident.erase(positions_[frame_id]);
+    lists_[frame_id] = NONE;
+    in_use_[frame_id] = false;
+    size_--;
+
+    ghost.push_front(page_ids_[frame_id]);
+    ghosts_[page_ids_[frame_id]] = std::make_pair(list, ghost.begin());
+    TrimGhosts();
+    value = values_[frame_id];
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Caller must hold latch_. |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c
+ */
+template <typename T> void ARCReplacer<T>::TrimGhosts() {
+  while (!b1_.empty() && t1_.size() + b1_.size() > num_frames_) {
+    ghosts_.erase(b1_.back());
+    b1_.pop_back();
+  }
+  while (!b2_.empty() && t1_.size() + t2_.size() + b1_.size() + b2_.size() >
+                             2 * num_frames_) {
+    ghosts_.erase(b2_.back());
+    b2_.pop_back();
+  }
+}
+
+template class ARCReplacer<Page *>;
+// test only
+template class ARCReplacer<int>;
+
+} // namespace scudb
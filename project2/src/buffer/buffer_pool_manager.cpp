@@ -1,26 +1,55 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <new>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_partition.h"
+#include "common/exception.h"
 
 namespace scudb {
 
 /*
  * BufferPoolManager Constructor
  * When log_manager is nullptr, logging is disabled (for test purpose)
- * WARNING: Do Not Edit This Function
+ * replacer_type picks the replacement policy, LRU unless told otherwise
+ * Frames, page table and replacer are set up for max_pool_size frames (at
+ * least pool_size), Resize() can grow the pool up to there. Frames above the
+ * pool size cost their metadata, their content is not committed.
  */
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                                  DiskManager *disk_manager,
-                                                 LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager),
-      log_manager_(log_manager) {
-  // a consecutive memory space for buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
-  replacer_ = new LRUReplacer<Page *>;
+                                                 LogManager *log_manager,
+                                                 ReplacerType replacer_type,
+                                                 size_t max_pool_size)
+    : pool_size_(pool_size),
+      capacity_(max_pool_size > pool_size ? max_pool_size : pool_size),
+      page_size_(disk_manager->GetPageSize()),
+      swizzle_slots_(page_size_ / (2 * sizeof(page_id_t))), frames_(capacity_), arena_(capacity_ * page_size_),
+      disk_manager_(disk_manager), log_manager_(log_manager),
+      replacer_type_(replacer_type), num_partitions_(1), num_misses_(0),
+      num_foreground_writes_(0),
+      writer_thread_(nullptr), writer_running_(false), num_pages_cleaned_(0),
+      warm_up_time_(0),
+      prefetch_thread_(nullptr), prefetch_running_(false),
+      prefetch_window_(PREFETCH_WINDOW), num_prefetched_(0) {
+  // a consecutive memory space for buffer pool, the page contents are in
+  // arena_ and the metadata in frames_
+  pages_ = static_cast<Page *>(::operator new(capacity_ * sizeof(Page)));
+  page_table_ = new PageTable<Page *>(capacity_);
+  // the default partition, every frame starts out in it
+  partitions_[0] = NewPartition("", 0, capacity_, nullptr);
   free_list_ = new std::list<Page *>;
 
-  // put all the pages into free list
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_->push_back(&pages_[i]);
+  // put the pages of the pool into free list, the rest wait for Resize()
+  for (size_t i = 0; i < capacity_; ++i) {
+    new (&pages_[i])
+        Page(frames_, i, arena_.GetData() + i * page_size_, page_size_);
+    frames_.page_ids_[i] = INVALID_PAGE_ID;
+    frames_.pin_counts_[i] = -1;
+    frames_.swizzled_from_[i] = -1;
+    if (i < pool_size_)
+      free_list_->push_back(&pages_[i]);
   }
 }
 
@@ -29,15 +58,51 @@ BufferPoolManager::BufferPoolManager(size_t pool_size,
  * WARNING: Do Not Edit This Function
  */
 BufferPoolManager::~BufferPoolManager() {
-  delete[] pages_;
+  StopWriterThread();
+  StopPrefetchThread();
+  for (size_t i = 0; i < capacity_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete(pages_);
   delete page_table_;
-  delete replacer_;
+  for (size_t i = 0; i < num_partitions_; ++i) {
+    delete partitions_[i]->view_;
+    for (size_t j = 0; j < NUM_PAGE_PRIORITIES; ++j)
+      delete partitions_[i]->replacers_[j];
+    delete partitions_[i];
+  }
   delete free_list_;
 }
 
+/*
+ * A partition with a replacer of the pool's policy per priority, each with a
+ * slot for every frame.
+ * Pin/unpin only touch per-frame state, accesses reach policy in batches.
+ */
+BufferPoolManager::Partition *
+BufferPoolManager::NewPartition(const std::string &name, size_t min_frames,
+                                size_t max_frames, BufferPoolPartition *view) {
+  Partition *partition =
+      new Partition{name, min_frames, max_frames, {}, view, 0, 0, 0};
+  for (size_t i = 0; i < NUM_PAGE_PRIORITIES; ++i) {
+    Replacer<Page *> *policy;
+    if (replacer_type_ == ReplacerType::CLOCK)
+      policy = new ClockReplacer<Page *>(capacity_);
+    else if (replacer_type_ == ReplacerType::LRU_K)
+      policy = new LRUKReplacer<Page *>(capacity_);
+    else if (replacer_type_ == ReplacerType::ARC)
+      policy = new ARCReplacer<Page *>(capacity_);
+    else
+      policy = new LRUReplacer<Page *>(capacity_);
+    partition->replacers_[i] = new BufferedReplacer<Page *>(policy, capacity_);
+  }
+  return partition;
+}
+
 /**
  * 1. search hash table.
- *  1.1 if exist, pin the page and return immediately
+ *  1.1 if exist, pin the page and return immediately (after waiting for the
+ *      read if another thread is still bringing it in)
  *  1.2 if no exist, find a replacement entry from either free list or lru
  *      replacer. (NOTE: always find from free list first)
  * 2. If the entry chosen for replacement is dirty, write it back to disk.
@@ -45,41 +110,168 @@ BufferPoolManager::~BufferPoolManager() {
  * entry for the new page.
  * 4. Update page metadata, read page content from disk file and return page
  * pointer
+ * A hit is served without latch_, writing only to the frame's own metadata.
+ * The write-back and the read happen without holding latch_ either.
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  assert(page_id != INVALID_PAGE_ID);
-  std::lock_guard<std::mutex> lck(latch_);
+Page *BufferPoolManager::FetchPage(page_id_t page_id, PagePriority priority) {
+  Page *page = PinPage(page_id, false);
+  if(page != nullptr) SetPriority(page, priority);
+  return page;
+}
+
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferRing *ring) {
+  return PinPage(page_id, false, ring);
+}
 
+/*
+ * FetchPage, and the read-ahead when prefetch is set: a page brought in by
+ * read-ahead is counted as prefetched rather than as a hit or a miss, and a
+ * resident page is pinned without recording an access.
+ * A page that is not resident is read into a frame of partition; a resident
+ * one stays in the partition that holds it.
+ */
+Page *BufferPoolManager::PinPage(page_id_t page_id, bool prefetch,
+                                 BufferRing *ring, size_t partition) {
+  assert(page_id != INVALID_PAGE_ID);
   Page *ans = nullptr;
-  if(page_table_->Find(page_id, ans)) {
-    ans->pin_count_++;  //pin the page
-    replacer_->Erase(ans);  //can not replace
+  if(page_table_->Find(page_id, ans) && TryPin(ans, page_id)) {
+    if(!prefetch) {
+      GetFrameReplacer(ans)->Erase(ans);  //can not replace
+      ans->hit_count_++;
+    }
+    if(ans->io_in_progress_) {
+      std::unique_lock<std::mutex> lck(latch_);
+      io_cv_.wait(lck, [ans] { return !ans->io_in_progress_; });
+    }
     return ans;
   }
 
-  if(!free_list_->empty()) {
-    ans = free_list_->front();  //find free list first
-    free_list_->pop_front();
+  // miss, or the frame was being replaced: retry under the latch
+  std::unique_lock<std::mutex> lck(latch_);
+  while (true) {
+    if(page_table_->Find(page_id, ans)) {
+      // a shrink is taking the frame away: wait until the page is out, then
+      // read it into a frame that stays
+      if(ans->frame_id_ >= pool_size_) {
+        io_cv_.wait(lck);
+        continue;
+      }
+      ans->pin_count_++;  //pin the page
+      if(!prefetch) {
+        GetFrameReplacer(ans)->Erase(ans);  //can not replace
+        ans->hit_count_++;
+      }
+      io_cv_.wait(lck, [ans] { return !ans->io_in_progress_; });
+      return ans;
+    }
+    // an eviction is still writing the page out, read it after that
+    if(flushing_.count(page_id) == 0) break;
+    io_cv_.wait(lck);
+  }
+
+  ans = ring == nullptr ? GetVictimPage(partition)
+                        : GetRingVictim(ring, page_id, partition);
+  if(ans == nullptr) return nullptr;
+  if(prefetch) {
+    num_prefetched_++;
   } else {
-    if(!replacer_->Victim(ans)) return nullptr;
-    
+    num_misses_++;
+    partitions_[partition]->num_misses_++;
   }
-  assert(ans->GetPinCount() == 0);
+  ReplacePage(ans, page_id, true, partition, lck);
 
-  if(ans->is_dirty_) {
-    //write it back to disk
-    disk_manager_->WritePage(ans->page_id_, ans->GetData());
+  return ans; 
+}
+
+/*
+ * Look page_id up for an optimistic read: no pin, no latch, nothing written.
+ * version is the snapshot to validate the read with (Page::ValidateVersion),
+ * odd while a writer or the disk is at work on the frame, then retry.
+ * Returns nullptr if the page is not in the pool, fall back to FetchPage.
+ */
+Page *BufferPoolManager::FetchPageOptimistic(page_id_t page_id,
+                                             uint64_t &version) {
+  Page *page = nullptr;
+  if(!page_table_->Find(page_id, page)) return nullptr;
+  version = page->GetVersion();
+  // the frame was given to another page since the lookup
+  if((version & 1) == 0 && page->page_id_ != page_id) return nullptr;
+  return page;
+}
+
+/*
+ * FetchPageOptimistic for the child in slot of the internal page parent.
+ * The slot is swizzled to the child's frame on the first fetch, later ones
+ * take the frame straight from it as long as it still holds child_page_id,
+ * without the page table. Unswizzle undoes it when the frame is reused.
+ * The parent's frame gets its swizzle table on the first swizzle, so only
+ * frames of internal pages pay for one.
+ */
+Page *BufferPoolManager::FetchChildOptimistic(Page *parent, int slot,
+                                              page_id_t child_page_id,
+                                              uint64_t &version) {
+  // a parent of another instance of a parallel pool may be out of range,
+  // its references share the slots of a frame here: they stay hints
+  if(slot < 0 || static_cast<size_t>(slot) >= swizzle_slots_ ||
+     parent->frame_id_ >= capacity_)
+    return FetchPageOptimistic(child_page_id, version);
+  std::atomic<int> *table = frames_.child_frames_[parent->frame_id_];
+  int frame_id = table == nullptr ? -1 : table[slot].load();
+  if(frame_id >= 0) {
+    Page *page = &pages_[frame_id];
+    version = page->GetVersion();
+    if((version & 1) == 0 && page->page_id_ == child_page_id) {
+      frames_.swizzle_hits_[frame_id]++;
+      return page;
+    }
   }
 
-  page_table_->Remove(ans->page_id_);
-  page_table_->Insert(page_id, ans);
+  Page *page = FetchPageOptimistic(child_page_id, version);
+  if(page != nullptr && (version & 1) == 0) {
+    if(table == nullptr)
+      table = frames_.GetChildFrames(parent->frame_id_, swizzle_slots_);
+    table[slot] = static_cast<int>(page->frame_id_);
+    frames_.swizzled_from_[page->frame_id_] =
+        static_cast<int64_t>(parent->frame_id_) << 32 | slot;
+  }
+  return page;
+}
+
+/*
+ * Pin frame, which an optimistic read found holding page_id, without looking
+ * it up again; FetchPage if it holds another page by now
+ */
+Page *BufferPoolManager::FetchFrame(Page *frame, page_id_t page_id) {
+  return PinFrame(frame, page_id, 0);
+}
 
-  ans->page_id_ = page_id;
-  ans->pin_count_ = 1;
-  ans->is_dirty_ = false;
-  disk_manager_->ReadPage(page_id, ans->GetData());
+Page *BufferPoolManager::PinFrame(Page *frame, page_id_t page_id,
+                                  size_t partition) {
+  if(frame < pages_ || frame >= pages_ + capacity_ || !TryPin(frame, page_id))
+    return PinPage(page_id, false, nullptr, partition);
+  GetFrameReplacer(frame)->Erase(frame);
+  frame->hit_count_++;
+  if(frame->io_in_progress_) {
+    std::unique_lock<std::mutex> lck(latch_);
+    io_cv_.wait(lck, [frame] { return !frame->io_in_progress_; });
+  }
+  return frame;
+}
 
-  return ans; 
+/*
+ * The frame goes to another page: clear the reference swizzled to it and
+ * the ones it holds to its children. Caller holds latch_
+ */
+void BufferPoolManager::Unswizzle(Page *frame) {
+  int frame_id = static_cast<int>(frame->frame_id_);
+  int64_t from = frames_.swizzled_from_[frame_id].exchange(-1);
+  if(from >= 0) {
+    std::atomic<int> *parent_table = frames_.child_frames_[from >> 32];
+    parent_table[from & 0xffffffff].compare_exchange_strong(frame_id, -1);
+  }
+  std::atomic<int> *table = frames_.child_frames_[frame_id];
+  if(table == nullptr) return;
+  for(size_t i = 0; i < swizzle_slots_; ++i) table[i] = -1;
 }
 
 /*
@@ -87,20 +279,28 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
  * if pin_count>0, decrement it and if it becomes zero, put it back to
  * replacer if pin_count<=0 before this call, return false. is_dirty: set the
  * dirty flag of this page
+ * The page goes to the replacer of its priority, the last hint it got.
+ * Runs without latch_: the caller's pin keeps the frame mapped to page_id.
  */
-bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  std::lock_guard<std::mutex> lck(latch_);
+bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty,
+                                  PagePriority priority) {
   Page *p = nullptr;
-  page_table_->Find(page_id, p);
-  if(p == nullptr) return false;
+  if(!page_table_->Find(page_id, p)) return false;
+  if(p->page_id_ != page_id) return false;
 
-  if(p->pin_count_ <= 0) return false;  //if pin_count<=0 before this call, return false
-  
-  p->pin_count_--;
-  if(p->pin_count_ == 0) {
-    replacer_->Insert(p);
-  }
+  // mark dirty before the pin goes, an evictor may take the frame right after
   if(is_dirty) p->is_dirty_ = true;
+  if(p->pin_count_ <= 0) return false;
+  SetPriority(p, priority);
+  int pin_count = p->pin_count_;
+  do {
+    if(pin_count <= 0) return false;  //if pin_count<=0 before this call, return false
+  } while(!p->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  // with conflicting hints the last unpin's view of the priority wins
+  if(pin_count == 1) {
+    GetFrameReplacer(p)->Insert(p);
+    NotifyUnpinned(p);
+  }
   return true;
 }
 
@@ -111,16 +311,37 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * NOTE: make sure page_id != INVALID_PAGE_ID
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  std::lock_guard<std::mutex> lck(latch_); 
+  std::unique_lock<std::mutex> lck(latch_);
   if(page_id == INVALID_PAGE_ID)  return false;
   
   Page *p = nullptr;
+  // the frame may get another page while we wait for its I/O
+  io_cv_.wait(lck, [this, page_id, &p] {
+    return !page_table_->Find(page_id, p) || !p->io_in_progress_;
+  });
   if(!page_table_->Find(page_id, p))  return false;
 
-  if(p->is_dirty_) {
-    disk_manager_->WritePage(page_id, p->GetData());
-    p->is_dirty_ = false;
+  // pinned so it is not evicted, marked so that another flush of the page
+  // cannot overtake this one with an older copy; the write goes without
+  // latch_, like the write-back of an eviction
+  p->pin_count_++;
+  p->io_in_progress_ = true;
+  lck.unlock();
+  std::unique_ptr<char[]> copy;
+  p->RLatch();
+  // clear first, so a concurrent unpin marking it dirty again is not lost
+  if(p->is_dirty_.exchange(false)) {
+    copy.reset(new char[page_size_]);
+    memcpy(copy.get(), p->GetData(), page_size_);
   }
+  p->RUnlatch();
+  if(copy != nullptr) WritePageOut(page_id, copy.get());
+  lck.lock();
+  p->io_in_progress_ = false;
+  io_cv_.notify_all();
+  lck.unlock();
+  // not an access, like a pin of the background writer
+  ReleasePrefetched(p);
   return true; 
 }
 
@@ -130,22 +351,39 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
  * table, buffer pool manager should be reponsible for removing this entry out
  * of page table, reseting page metadata and adding back to free list. Second,
  * call disk manager's DeallocatePage() method to delete from disk file. If
- * the page is found within page table, but pin_count != 0, return false
+ * the page is found within page table, but pin_count != 0, return false.
+ * A page that is not in the pool is deallocated all the same, once a
+ * write-back of it is done (it must not land on the page's next owner)
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-  std::lock_guard<std::mutex> lck(latch_);
+  std::unique_lock<std::mutex> lck(latch_);
   if(page_id == INVALID_PAGE_ID)  return false;
   Page *p = nullptr;
-  if(!page_table_->Find(page_id, p))  return false;
+  io_cv_.wait(lck, [this, page_id] { return flushing_.count(page_id) == 0; });
+  if(!page_table_->Find(page_id, p)) {
+    if(compressed_cache_ != nullptr) compressed_cache_->Erase(page_id);
+    if(shared_cache_ != nullptr) shared_cache_->Erase(page_id);
+    disk_manager_->DeallocatePage(page_id);
+    return true;
+  }
 
-  //if page is found within page
-  if(p->pin_count_ != 0)  return false;   //pin_count != 0, return false
-  replacer_->Erase(p);
-  page_table_->Remove(p->page_id_);   //removing this entry out of page table
+  //if page is found within page, claim it so nobody can pin it any more
+  int pin_count = 0;
+  if(!p->pin_count_.compare_exchange_strong(pin_count, -1))  return false;   //pin_count != 0, return false
+  GetFrameReplacer(p)->Erase(p);
+  partitions_[frames_.partition_ids_[p->frame_id_]]->num_frames_--;
+  page_table_->Remove(page_id);   //removing this entry out of page table
+  p->BeginWrite();
+  Unswizzle(p);
+  p->page_id_ = INVALID_PAGE_ID;
   p->is_dirty_ = false;
   p->ResetMemory(); //reseting page metadata
-  free_list_->push_back(p); //adding back to free list
+  p->EndWrite();
+  //adding back to free list, unless a shrinking pool is taking it away
+  if(p->frame_id_ < pool_size_) free_list_->push_back(p);
 
+  if(compressed_cache_ != nullptr) compressed_cache_->Erase(page_id);
+  if(shared_cache_ != nullptr) shared_cache_->Erase(page_id);
   disk_manager_->DeallocatePage(page_id); //delete from disk file
   return true; 
 }
@@ -159,32 +397,930 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * into page table. return nullptr if all the pages in pool are pinned
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) { 
+  return NewPageIn(page_id, 0);
+}
+
+Page *BufferPoolManager::NewPage(page_id_t &page_id, Extent *extent) {
+  return NewPageIn(page_id, 0, extent);
+}
+
+Page *BufferPoolManager::NewPageIn(page_id_t &page_id, size_t partition,
+                                   Extent *extent) {
+  std::unique_lock<std::mutex> lck(latch_);
+
+  Page *ans = GetVictimPage(partition);
+  if(ans == nullptr) return nullptr;
+
+  //call disk manager to allocate a page
+  page_id = extent == nullptr ? disk_manager_->AllocatePage()
+                              : extent->AllocatePage(disk_manager_);
+  ReplacePage(ans, page_id, false, partition, lck);
+
+  return ans;
+}
+
+/*
+ * Same as NewPage(), but the page id has already been allocated by the caller.
+ * Used by ParallelBufferPoolManager, which has to know the page id before it
+ * can pick the instance that owns it.
+ */
+Page *BufferPoolManager::NewPageWithId(page_id_t page_id, size_t partition) {
+  std::unique_lock<std::mutex> lck(latch_);
+
+  Page *ans = GetVictimPage(partition);
+  if(ans == nullptr) return nullptr;
+  ReplacePage(ans, page_id, false, partition, lck);
+
+  return ans;
+}
+
+/*
+ * NewPage where the page id picks the pool (or the share of a partition)
+ * the page goes to, so it has to be allocated before we know where the page
+ * goes. If new_page_with_id fails, e.g. that pool has every frame pinned,
+ * give the id back (to the disk manager or the extent) and report failure
+ * like NewPage does.
+ */
+Page *BufferPoolManager::NewPageRouted(
+    page_id_t &page_id, Extent *extent, DiskManager *disk_manager,
+    const std::function<Page *(page_id_t)> &new_page_with_id) {
+  page_id_t new_page_id = extent == nullptr
+                              ? disk_manager->AllocatePage()
+                              : extent->AllocatePage(disk_manager);
+  Page *page = new_page_with_id(new_page_id);
+  if(page == nullptr) {
+    if(extent == nullptr)
+      disk_manager->DeallocatePage(new_page_id);
+    else
+      extent->DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+size_t BufferPoolManager::GetPoolSize() { return pool_size_; }
+
+size_t BufferPoolManager::GetMaxPoolSize() { return capacity_; }
+
+/*
+ * Content of the frames in use, plus the metadata of every frame and the
+ * swizzle tables of the frames that held internal pages
+ */
+size_t BufferPoolManager::GetMemoryUsage() {
+  return pool_size_ * page_size_ +
+         capacity_ * (sizeof(Page) + FrameTable::BytesPerFrame()) +
+         frames_.num_child_tables_ * swizzle_slots_ * sizeof(std::atomic<int>);
+}
+
+/*
+ * Change the number of frames online, between 1 and GetMaxPoolSize().
+ * Growing hands the frames above the pool size to the free list. Shrinking
+ * takes the top frames away: free and clean unpinned ones at once, dirty ones
+ * after writing them back, pinned ones last, once they are unpinned. A frame
+ * above the new size is not pinned again (TryPin), a fetch of its page waits
+ * until it is taken away and reads the page into a frame that stays, so hot
+ * pages cannot hold the shrink off; a thread must not fetch a page again
+ * while it has it pinned meanwhile. latch_ is only held for the bookkeeping,
+ * never while writing or waiting, and the content of the frames taken away
+ * goes back to the system.
+ */
+void BufferPoolManager::Resize(size_t new_size) {
+  std::lock_guard<std::mutex> resize_lck(resize_latch_);
+  if(new_size < 1) new_size = 1;
+  if(new_size > capacity_) new_size = capacity_;
+  std::unique_lock<std::mutex> lck(latch_);
+  size_t old_size = pool_size_;
+  if(new_size >= old_size) {
+    for(size_t i = old_size; i < new_size; ++i)
+      free_list_->push_back(&pages_[i]);
+    pool_size_ = new_size;
+    // fetchers waiting for frames of a shrink that ended up kept
+    io_cv_.notify_all();
+    return;
+  }
+
+  // from here on no victim, free frame or ring frame is taken above new_size
+  pool_size_ = new_size;
+  free_list_->remove_if(
+      [new_size](Page *page) { return page->frame_id_ >= new_size; });
+  std::vector<Page *> pinned;
+  for(size_t i = new_size; i < old_size; ++i) {
+    if(pages_[i].pin_count_ > 0)
+      pinned.push_back(&pages_[i]);
+    else
+      RetireFrame(&pages_[i], lck);
+  }
+  for(Page *frame : pinned) RetireFrame(frame, lck);
+  lck.unlock();
+  arena_.Release(new_size * page_size_, (old_size - new_size) * page_size_);
+}
+
+/*
+ * Take a frame out of a shrinking pool, waiting on unpin_cv_ (without latch_)
+ * until it is unpinned and writing it back (without latch_) if dirty. Caller
+ * must hold latch_ through lck, it is held again on return
+ */
+void BufferPoolManager::RetireFrame(Page *frame,
+                                    std::unique_lock<std::mutex> &lck) {
+  while(true) {
+    // free frames hold no page
+    if(frame->page_id_ == INVALID_PAGE_ID) return;
+    int pin_count = 0;
+    if(frame->pin_count_.compare_exchange_strong(pin_count, -1)) break;
+    unpin_cv_.wait(lck);
+  }
+  GetFrameReplacer(frame)->Erase(frame);
+  partitions_[frames_.partition_ids_[frame->frame_id_]]->num_frames_--;
+  page_id_t page_id = frame->page_id_;
+  bool write_back = frame->is_dirty_;
+  frame->BeginWrite();
+  Unswizzle(frame);
+  page_table_->Remove(page_id);
+  // fetchers waiting for the frame to go read the page into another one
+  io_cv_.notify_all();
+  if(write_back || compressed_cache_ != nullptr) {
+    // fetchers of the page wait until it is on disk or compressed
+    flushing_.insert(page_id);
+    lck.unlock();
+    if(write_back)
+      WritePageOut(page_id, frame->GetData());
+    else
+      compressed_cache_->Put(page_id, frame->GetData());
+    lck.lock();
+    flushing_.erase(page_id);
+    io_cv_.notify_all();
+  }
+  frame->page_id_ = INVALID_PAGE_ID;
+  frame->is_dirty_ = false;
+  frame->EndWrite();
+}
+
+size_t BufferPoolManager::GetNumHits() {
+  size_t num_hits = 0;
+  for (size_t i = 0; i < capacity_; ++i) {
+    num_hits += frames_.hit_counts_[i];
+  }
+  return num_hits;
+}
+
+size_t BufferPoolManager::GetNumMisses() { return num_misses_.load(); }
+
+size_t BufferPoolManager::GetNumSwizzleHits() {
+  size_t num_hits = 0;
+  for (size_t i = 0; i < capacity_; ++i) {
+    num_hits += frames_.swizzle_hits_[i];
+  }
+  return num_hits;
+}
+
+/*
+ * Start the background writer. Every BG_WRITER_DELAY (or sooner, when a
+ * foreground write-back wakes it) it looks at the pages the replacer would
+ * evict next and writes the dirty ones out, so that eviction finds them
+ * clean.
+ */
+void BufferPoolManager::RunWriterThread() {
+  std::lock_guard<std::mutex> lck(writer_latch_);
+  if(writer_thread_ != nullptr) return;
+  writer_running_ = true;
+  writer_start_ = std::chrono::steady_clock::now();
+  writer_thread_ = new std::thread([this] {
+    auto last_image = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> writer_lck(writer_latch_);
+    while(writer_running_) {
+      std::string image_file = warm_image_file_;
+      writer_lck.unlock();
+      CleanPages();
+      if(!image_file.empty() &&
+         std::chrono::steady_clock::now() - last_image >= WARM_IMAGE_DELAY) {
+        SaveWarmImage(image_file);
+        last_image = std::chrono::steady_clock::now();
+      }
+      writer_lck.lock();
+      writer_cv_.wait_for(writer_lck, BG_WRITER_DELAY);
+    }
+  });
+}
+
+/*
+ * Stop and join the background writer
+ */
+void BufferPoolManager::StopWriterThread() {
+  std::thread *writer_thread;
+  {
+    std::lock_guard<std::mutex> lck(writer_latch_);
+    if(writer_thread_ == nullptr) return;
+    writer_running_ = false;
+    writer_thread = writer_thread_;
+    writer_thread_ = nullptr;
+  }
+  writer_cv_.notify_one();
+  writer_thread->join();
+  delete writer_thread;
+  // the last image before a shutdown
+  std::string image_file;
+  {
+    std::lock_guard<std::mutex> lck(writer_latch_);
+    image_file = warm_image_file_;
+  }
+  if(!image_file.empty()) SaveWarmImage(image_file);
+  // what the writer wrote is durable once it stopped
+  disk_manager_->Sync();
+}
+
+void BufferPoolManager::SetWarmImageFile(const std::string &file_name) {
+  std::lock_guard<std::mutex> lck(writer_latch_);
+  warm_image_file_ = file_name;
+}
+
+/*
+ * Warm-up image: magic, page size, number of pages, then a page id and a
+ * temperature per page. It is written aside and renamed over the old one, a
+ * crash never leaves a torn image.
+ */
+bool BufferPoolManager::SaveWarmImage(const std::string &file_name) {
+  std::vector<WarmPage> pages;
+  GetResidentPages(pages);
+  return WriteWarmImage(file_name, page_size_, pages);
+}
+
+bool BufferPoolManager::WriteWarmImage(const std::string &file_name,
+                                       size_t page_size,
+                                       const std::vector<WarmPage> &pages) {
+  std::string tmp_name = file_name + ".tmp";
+  std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+  uint32_t header[3] = {WARM_IMAGE_MAGIC, static_cast<uint32_t>(page_size),
+                        static_cast<uint32_t>(pages.size())};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  for(auto &page : pages) {
+    out.write(reinterpret_cast<const char *>(&page.first), sizeof(page_id_t));
+    out.write(reinterpret_cast<const char *>(&page.second), sizeof(uint32_t));
+  }
+  out.close();
+  if(!out) {
+    std::remove(tmp_name.c_str());
+    return false;
+  }
+  return std::rename(tmp_name.c_str(), file_name.c_str()) == 0;
+}
+
+/*
+ * Load the hottest pages of a warm-up image that fit into the pool. They
+ * are read in runs of consecutive page ids, one disk read per run of up to
+ * WARM_UP_MAX_RUN pages with DISK_IO_QUEUE_DEPTH runs in flight, and only go
+ * to free frames: nothing is evicted.
+ * The coldest page is unpinned first, so it is also the first victim.
+ */
+size_t BufferPoolManager::WarmUp(const std::string &file_name) {
+  auto start = std::chrono::steady_clock::now();
+  size_t num_warmed = LoadWarmImage(
+      file_name, page_size_, GetPoolSize(), disk_manager_,
+      [this](page_id_t page_id, const char *page_data) {
+        return InstallPage(page_id, page_data);
+      },
+      this);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  warm_up_time_ = elapsed.count();
+  return num_warmed;
+}
+
+size_t BufferPoolManager::LoadWarmImage(
+    const std::string &file_name, size_t page_size, size_t num_frames,
+    DiskManager *disk_manager,
+    const std::function<Page *(page_id_t, const char *)> &install,
+    BufferPool *pool) {
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t header[3];
+  if(!in.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+     header[0] != WARM_IMAGE_MAGIC || header[1] != page_size)
+    return 0;
+  std::vector<WarmPage> pages;
+  for(uint32_t i = 0; i < header[2]; i++) {
+    WarmPage page;
+    if(!in.read(reinterpret_cast<char *>(&page.first), sizeof(page_id_t)) ||
+       !in.read(reinterpret_cast<char *>(&page.second), sizeof(uint32_t)))
+      return 0;
+    if(page.first >= 0) pages.push_back(page);
+  }
+
+  // hottest first, as many as there are frames
+  std::sort(pages.begin(), pages.end(),
+            [](const WarmPage &a, const WarmPage &b) {
+              return a.second > b.second ||
+                     (a.second == b.second && a.first < b.first);
+            });
+  if(pages.size() > num_frames) pages.resize(num_frames);
+  std::vector<page_id_t> page_ids;
+  for(auto &page : pages) page_ids.push_back(page.first);
+  std::sort(page_ids.begin(), page_ids.end());
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+
+  // runs as (index of the first page, length)
+  std::vector<std::pair<size_t, int>> runs;
+  for(size_t i = 0; i < page_ids.size();) {
+    int run = 1;
+    while(i + run < page_ids.size() && run < WARM_UP_MAX_RUN &&
+          page_ids[i + run] == page_ids[i] + run)
+      run++;
+    runs.push_back(std::make_pair(i, run));
+    i += run;
+  }
+  std::unordered_set<page_id_t> installed;
+  for(size_t first = 0; first < runs.size(); first += DISK_IO_QUEUE_DEPTH) {
+    size_t last = std::min(runs.size(), first + DISK_IO_QUEUE_DEPTH);
+    size_t begin = runs[first].first;
+    size_t end = runs[last - 1].first + runs[last - 1].second;
+    std::vector<char> buffer((end - begin) * page_size);
+    std::vector<std::future<int>> reads;
+    for(size_t r = first; r < last; r++) {
+      reads.push_back(disk_manager->ReadPagesAsync(
+          page_ids[runs[r].first], runs[r].second,
+          buffer.data() + (runs[r].first - begin) * page_size));
+    }
+    for(size_t r = first; r < last; r++) {
+      // pages past the end of the file are left out
+      int num_read = reads[r - first].get();
+      for(int j = 0; j < num_read; j++) {
+        size_t i = runs[r].first + j;
+        if(install(page_ids[i], buffer.data() + (i - begin) * page_size) !=
+           nullptr)
+          installed.insert(page_ids[i]);
+      }
+    }
+  }
+  size_t num_warmed = installed.size();
+  for(auto page = pages.rbegin(); page != pages.rend(); ++page) {
+    if(installed.erase(page->first) > 0) pool->UnpinPage(page->first, false);
+  }
+  return num_warmed;
+}
+
+void BufferPoolManager::GetResidentPages(std::vector<WarmPage> &pages) {
+  std::lock_guard<std::mutex> lck(latch_);
+  for(size_t i = 0; i < capacity_; ++i) {
+    if(frames_.page_ids_[i] == INVALID_PAGE_ID || frames_.pin_counts_[i] < 0)
+      continue;
+    size_t temperature = frames_.hit_counts_[i] - frames_.load_hit_counts_[i];
+    pages.push_back(WarmPage(frames_.page_ids_[i],
+                             static_cast<uint32_t>(std::min<size_t>(
+                                 temperature, UINT32_MAX))));
+  }
+}
+
+/*
+ * Map page_id onto a free frame holding page_data, pinned. nullptr if the
+ * page is already in the pool, on its way to disk, or no frame is free.
+ */
+Page *BufferPoolManager::InstallPage(page_id_t page_id, const char *page_data) {
   std::lock_guard<std::mutex> lck(latch_);
+  Page *frame = nullptr;
+  if(free_list_->empty() || page_table_->Find(page_id, frame) ||
+     flushing_.count(page_id) > 0)
+    return nullptr;
+  frame = free_list_->front();
+  free_list_->pop_front();
+  frame->BeginWrite();
+  Unswizzle(frame);
+  AssignFrame(frame, 0);
+  page_table_->Insert(page_id, frame);
+  frame->page_id_ = page_id;
+  frame->is_dirty_ = false;
+  memcpy(frame->GetData(), page_data, page_size_);
+  frame->EndWrite();
+  frame->pin_count_ = 1;
+  return frame;
+}
 
+size_t BufferPoolManager::GetNumPagesCleaned() {
+  return num_pages_cleaned_.load();
+}
+
+double BufferPoolManager::GetWriterFlushRate() {
+  std::lock_guard<std::mutex> lck(writer_latch_);
+  if(writer_thread_ == nullptr) return 0;
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - writer_start_;
+  return num_pages_cleaned_.load() / elapsed.count();
+}
+
+size_t BufferPoolManager::GetNumForegroundWrites() {
+  return num_foreground_writes_.load();
+}
+
+/*
+ * Queue a read-ahead of the pages following page_id along a chain, e.g. the
+ * next_page_id links of table pages or B+ tree leaves. A scan calls this when
+ * it steps onto the next page of the chain; a thread started on first use
+ * brings the next GetPrefetchWindow() pages into free or evictable frames
+ * while the scan works on the current one. Returns immediately.
+ */
+void BufferPoolManager::ReadAhead(page_id_t page_id, NextPageFunc next_page) {
+  QueueReadAhead(page_id, std::move(next_page), this);
+}
+
+void BufferPoolManager::QueueReadAhead(page_id_t page_id,
+                                       NextPageFunc next_page,
+                                       BufferPool *pool) {
+  if(page_id == INVALID_PAGE_ID || prefetch_window_ == 0) return;
+  {
+    std::lock_guard<std::mutex> lck(prefetch_latch_);
+    // the scan is already ahead of the prefetcher, the old requests are stale
+    if(prefetch_queue_.size() >= PREFETCH_MAX_REQUESTS)
+      prefetch_queue_.pop_front();
+    prefetch_queue_.push_back(
+        PrefetchRequest{page_id, std::move(next_page), pool});
+    if(prefetch_thread_ == nullptr) {
+      prefetch_running_ = true;
+      prefetch_thread_ = new std::thread([this] { PrefetchLoop(); });
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+size_t BufferPoolManager::GetNumPrefetched() { return num_prefetched_.load(); }
+
+/*
+ * Serve read-ahead requests until stopped. Each page of the window is pinned
+ * just long enough to read its successor, then released without counting as
+ * an access. The walk stops early when every frame is pinned.
+ */
+void BufferPoolManager::PrefetchLoop() {
+  std::unique_lock<std::mutex> lck(prefetch_latch_);
+  while(true) {
+    prefetch_cv_.wait(lck, [this] {
+      return !prefetch_running_ || !prefetch_queue_.empty();
+    });
+    if(!prefetch_running_) return;
+    PrefetchRequest request = std::move(prefetch_queue_.front());
+    prefetch_queue_.pop_front();
+    lck.unlock();
+
+    page_id_t page_id = request.page_id_;
+    for(size_t i = 0; i < prefetch_window_ && page_id != INVALID_PAGE_ID; ++i) {
+      Page *page = request.pool_->PrefetchPage(page_id);
+      if(page == nullptr) break;
+      page->RLatch();
+      page_id = request.next_page_(page);
+      page->RUnlatch();
+      request.pool_->ReleasePrefetched(page);
+    }
+    lck.lock();
+  }
+}
+
+/*
+ * Stop and join the read-ahead thread, dropping pending requests
+ */
+void BufferPoolManager::StopPrefetchThread() {
+  std::thread *prefetch_thread;
+  {
+    std::lock_guard<std::mutex> lck(prefetch_latch_);
+    prefetch_queue_.clear();
+    if(prefetch_thread_ == nullptr) return;
+    prefetch_running_ = false;
+    prefetch_thread = prefetch_thread_;
+    prefetch_thread_ = nullptr;
+  }
+  prefetch_cv_.notify_one();
+  prefetch_thread->join();
+  delete prefetch_thread;
+}
+
+Page *BufferPoolManager::PrefetchPage(page_id_t page_id) {
+  return PinPage(page_id, true, nullptr, 0);
+}
+
+// not an access: leave the page where it is in the replacer
+void BufferPoolManager::ReleasePrefetched(Page *page) {
+  if(page->pin_count_.fetch_sub(1) == 1) {
+    GetFrameReplacer(page)->Reinsert(page);
+    NotifyUnpinned(page);
+  }
+}
+
+/*
+ * Clean the next victims. A candidate is pinned and read latched for the
+ * write, so it can neither be evicted (and reread stale) nor modified while
+ * it is on its way out. If the replacer cannot tell its next victims, any
+ * unpinned dirty page will do.
+ */
+void BufferPoolManager::CleanPages() {
+  std::vector<Page *> candidates;
+  bool peeked = true;
+  for(size_t i = 0; i < num_partitions_; ++i) {
+    for(auto replacer : partitions_[i]->replacers_) {
+      if(!replacer->PeekVictims(candidates, BG_WRITER_MAX_PAGES))
+        peeked = false;
+    }
+  }
+  if(!peeked) {
+    candidates.clear();
+    for(size_t i = 0; i < pool_size_ && candidates.size() < BG_WRITER_MAX_PAGES;
+        ++i) {
+      if(frames_.pin_counts_[i] == 0 && frames_.is_dirty_[i])
+        candidates.push_back(&pages_[i]);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+
+  // the writes are all in flight at once. Each page is latched only while
+  // it is copied: a latch held across the writes could deadlock with a
+  // thread that pinned some of the pages meanwhile and latches them in turn
+  // (B+ tree crabbing). A page stays pinned until its own write is done, so
+  // that it is not evicted and read back before the disk has the copy
+  std::unique_ptr<char[]> copies(new char[candidates.size() * page_size_]);
+  std::vector<std::pair<Page *, std::future<void>>> writes;
+  for(Page *page : candidates) {
+    page_id_t page_id = page->page_id_;
+    if(!page->is_dirty_ || page_id == INVALID_PAGE_ID) continue;
+    if(!TryPin(page, page_id)) continue;
+    if(!page->io_in_progress_) {
+      char *copy = copies.get() + writes.size() * page_size_;
+      page->RLatch();
+      // a page the log is not on disk for yet is left to a later round, the
+      // writer does not wait for the log flush
+      bool is_dirty = !WaitsForLog(page_id, page->GetData()) &&
+                      page->is_dirty_.exchange(false);
+      if(is_dirty) memcpy(copy, page->GetData(), page_size_);
+      page->RUnlatch();
+      if(is_dirty) {
+        writes.emplace_back(page, WritePageOutAsync(page_id, copy));
+        continue;
+      }
+    }
+    // not an access, like a read-ahead pin
+    ReleasePrefetched(page);
+  }
+  for(auto &write : writes) {
+    Page *page = write.first;
+    write.second.wait();
+    num_pages_cleaned_++;
+    ReleasePrefetched(page);
+  }
+}
+
+/*
+ * WAL: a page may only reach disk after the log records up to its LSN. The
+ * header page carries no LSN.
+ */
+bool BufferPoolManager::WaitsForLog(page_id_t page_id,
+                                    const char *page_data) {
+  if(!ENABLE_LOGGING || log_manager_ == nullptr || page_id == HEADER_PAGE_ID)
+    return false;
+  lsn_t lsn;
+  memcpy(&lsn, page_data + 4, sizeof(lsn_t));
+  return log_manager_->NeedsFlush(lsn);
+}
+
+void BufferPoolManager::PrepareWriteOut(page_id_t page_id,
+                                        const char *page_data) {
+  if(WaitsForLog(page_id, page_data)) {
+    lsn_t lsn;
+    memcpy(&lsn, page_data + 4, sizeof(lsn_t));
+    log_manager_->ForceFlush(lsn);
+  }
+  // a compressed copy would now be stale
+  if(compressed_cache_ != nullptr) compressed_cache_->Erase(page_id);
+  // the other processes read the new version from now on
+  if(shared_cache_ != nullptr) shared_cache_->Put(page_id, page_data);
+}
+
+void BufferPoolManager::WritePageOut(page_id_t page_id, const char *page_data) {
+  PrepareWriteOut(page_id, page_data);
+  disk_manager_->WritePage(page_id, page_data);
+}
+
+std::future<void> BufferPoolManager::WritePageOutAsync(page_id_t page_id,
+                                                       const char *page_data) {
+  PrepareWriteOut(page_id, page_data);
+  return disk_manager_->WritePageAsync(page_id, page_data);
+}
+
+void BufferPoolManager::ReadPageIn(page_id_t page_id, char *page_data) {
+  if(compressed_cache_ != nullptr && compressed_cache_->Get(page_id, page_data))
+    return;
+  if(shared_cache_ != nullptr && shared_cache_->Get(page_id, page_data))
+    return;
+  disk_manager_->ReadPage(page_id, page_data);
+  if(shared_cache_ != nullptr) shared_cache_->Put(page_id, page_data);
+}
+
+void BufferPoolManager::EnableCompressedCache(size_t budget) {
+  compressed_cache_.reset(
+      budget == 0 ? nullptr : new CompressedCache(budget, page_size_));
+}
+
+size_t BufferPoolManager::GetNumCompressedHits() {
+  return compressed_cache_ == nullptr ? 0 : compressed_cache_->GetNumHits();
+}
+
+size_t BufferPoolManager::GetNumCompressedMisses() {
+  return compressed_cache_ == nullptr ? 0 : compressed_cache_->GetNumMisses();
+}
+
+void BufferPoolManager::EnableSharedCache(const std::string &name,
+                                          size_t num_pages) {
+  shared_cache_.reset(num_pages == 0 ? nullptr
+                                     : new SharedPageCache(
+                                           name, num_pages, page_size_,
+                                           disk_manager_->GetFileName()));
+}
+
+size_t BufferPoolManager::GetNumSharedHits() {
+  return shared_cache_ == nullptr ? 0 : shared_cache_->GetNumHits();
+}
+
+size_t BufferPoolManager::GetNumSharedMisses() {
+  return shared_cache_ == nullptr ? 0 : shared_cache_->GetNumMisses();
+}
+
+/*
+ * Find a replacement frame for a page of partition from either free list or
+ * lru replacer (NOTE: always find from free list first).
+ * A partition at its quota replaces one of its own pages, even if frames are
+ * free. One below its minimum share takes the page of a partition above its
+ * own share first; otherwise it replaces one of its own, and only if all of
+ * those are pinned one of another partition above its share.
+ * The frame is returned claimed (pin count -1).
+ * Caller must hold latch_. return nullptr if all the pages in pool are pinned
+ */
+Page *BufferPoolManager::GetVictimPage(size_t partition) {
+  Partition *part = partitions_[partition];
+  bool at_quota = part->num_frames_ >= part->max_frames_;
   Page *ans = nullptr;
-  if(!free_list_->empty()) {
+  if(!at_quota && !free_list_->empty()) {
     ans = free_list_->front();  //find free list first
     free_list_->pop_front();
+    assert(ans->GetPinCount() == -1);
+    return ans;
+  }
+  if(!at_quota && part->num_frames_ < part->min_frames_) {
+    ans = StealVictim(partition);
+    if(ans != nullptr) return ans;
+  }
+  ans = TakeVictim(partition);
+  if(ans == nullptr && !at_quota) ans = StealVictim(partition);
+  return ans;
+}
+
+/*
+ * Lower priorities go first: a page of a higher priority, e.g. a B+ tree root,
+ * is not evicted as long as one of a lower priority can be.
+ * A victim that got pinned without the latch after the replacer picked it
+ * is skipped, its unpin hands it back to the replacer.
+ * Caller must hold latch_
+ */
+Page *BufferPoolManager::TakeVictim(size_t partition) {
+  Page *ans = nullptr;
+  for(size_t priority = 0; priority < NUM_PAGE_PRIORITIES; ++priority) {
+    while (partitions_[partition]->replacers_[priority]->Victim(ans)) {
+      // Resize() is taking the frame out of the pool
+      if(ans->frame_id_ >= pool_size_) continue;
+      // a late unpin left the frame here after it went to another partition
+      // or priority
+      if(frames_.partition_ids_[ans->frame_id_] != partition ||
+         frames_.priorities_[ans->frame_id_] != priority)
+        continue;
+      int pin_count = 0;
+      if(ans->pin_count_.compare_exchange_strong(pin_count, -1)) return ans;
+    }
+  }
+  return nullptr;
+}
+
+/*
+ * The partition furthest above its minimum share gives up a page first.
+ * Caller must hold latch_
+ */
+Page *BufferPoolManager::StealVictim(size_t partition) {
+  std::vector<std::pair<size_t, size_t>> others; // surplus, partition
+  for(size_t i = 0; i < num_partitions_; ++i) {
+    Partition *other = partitions_[i];
+    if(i != partition && other->num_frames_ > other->min_frames_)
+      others.push_back(std::make_pair(other->num_frames_ - other->min_frames_, i));
+  }
+  std::sort(others.rbegin(), others.rend());
+  for(auto &other : others) {
+    Page *ans = TakeVictim(other.second);
+    if(ans != nullptr) return ans;
+  }
+  return nullptr;
+}
+
+/*
+ * Victim for a ring scan. Take the next frame of the ring that belongs to
+ * this pool, is unpinned and still holds the page the scan left in it. Until
+ * the ring is full, or if none of its frames can be recycled, take a victim
+ * from the pool as usual and remember it in the ring.
+ * Caller must hold latch_. return nullptr if all the pages in pool are pinned
+ */
+Page *BufferPoolManager::GetRingVictim(BufferRing *ring, page_id_t page_id,
+                                       size_t partition) {
+  size_t num_frames = ring->frames_.size();
+  if(num_frames == ring->size_) {
+    for(size_t i = 0; i < num_frames; ++i) {
+      size_t slot = (ring->next_ + i) % num_frames;
+      Page *frame = ring->frames_[slot];
+      // a parallel pool shares the ring among its instances
+      if(frame < pages_ || frame >= pages_ + pool_size_) continue;
+      if(frame->page_id_ != ring->page_ids_[slot]) continue;
+      int pin_count = 0;
+      if(!frame->pin_count_.compare_exchange_strong(pin_count, -1)) continue;
+      GetFrameReplacer(frame)->Erase(frame);
+      ring->page_ids_[slot] = page_id;
+      ring->next_ = (slot + 1) % num_frames;
+      return frame;
+    }
+  }
+
+  Page *frame = GetVictimPage(partition);
+  if(frame == nullptr) return nullptr;
+  if(num_frames < ring->size_) {
+    ring->frames_.push_back(frame);
+    ring->page_ids_.push_back(page_id);
+  } else if(num_frames > 0) {
+    ring->frames_[ring->next_] = frame;
+    ring->page_ids_[ring->next_] = page_id;
+    ring->next_ = (ring->next_ + 1) % num_frames;
+  }
+  return frame;
+}
+
+/*
+ * Pin a frame found in the page table without holding latch_. Fails if the
+ * frame is claimed for replacement, or if it was handed to another page
+ * between the lookup and the pin.
+ */
+bool BufferPoolManager::TryPin(Page *page, page_id_t page_id) {
+  int pin_count = page->pin_count_;
+  do {
+    if(pin_count < 0) return false;
+  } while(!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // a frame a shrink is taking away is not pinned again
+  if(page->page_id_ == page_id && page->frame_id_ < pool_size_) return true;
+  Unpin(page);
+  return false;
+}
+
+void BufferPoolManager::Unpin(Page *page) {
+  if(page->pin_count_.fetch_sub(1) == 1) {
+    GetFrameReplacer(page)->Insert(page);
+    NotifyUnpinned(page);
+  }
+}
+
+/*
+ * Wake a Resize() waiting for the last pin of a frame above the pool size.
+ * latch_ is taken so the wakeup cannot fall between RetireFrame's check of
+ * the pin count and its wait
+ */
+void BufferPoolManager::NotifyUnpinned(Page *page) {
+  if(page->frame_id_ < pool_size_) return;
+  std::lock_guard<std::mutex> lck(latch_);
+  unpin_cv_.notify_all();
+}
+
+/*
+ * Map page_id onto the victim frame, pinned and marked as doing I/O, then
+ * release latch_ while the old content is written back (if dirty) and the
+ * new content is read in (or zeroed for a new page).
+ * Fetchers of page_id find the frame and wait for the I/O to finish; fetchers
+ * of the old page see it in flushing_ and wait until it is on disk (or in the
+ * compressed tier).
+ * Caller must hold latch_ through lck, it is held again on return
+ */
+void BufferPoolManager::ReplacePage(Page *frame, page_id_t page_id,
+                                    bool read_page, size_t partition,
+                                    std::unique_lock<std::mutex> &lck) {
+  page_id_t old_page_id = frame->page_id_;
+  bool write_back = frame->is_dirty_;
+  // a clean old page goes to the compressed tier instead
+  bool compress = !write_back && compressed_cache_ != nullptr &&
+                  old_page_id != INVALID_PAGE_ID;
+  // optimistic readers of the old page fail from here on
+  frame->BeginWrite();
+  Unswizzle(frame);
+  if(old_page_id != INVALID_PAGE_ID) {
+    page_table_->Remove(old_page_id);
+    partitions_[frames_.partition_ids_[frame->frame_id_]]->num_frames_--;
+  }
+  page_table_->Insert(page_id, frame);
+  if(write_back || compress) flushing_.insert(old_page_id);
+
+  // the pin goes last: whoever pins the frame sees the rest already set
+  AssignFrame(frame, partition);
+  frame->page_id_ = page_id;
+  frame->is_dirty_ = false;
+  frame->io_in_progress_ = true;
+  frame->pin_count_ = 1;
+
+  lck.unlock();
+  if(write_back) {
+    //write it back to disk, the background writer was too slow for this one
+    WritePageOut(old_page_id, frame->GetData());
+    num_foreground_writes_++;
+    writer_cv_.notify_one();
+  } else if(compress) {
+    compressed_cache_->Put(old_page_id, frame->GetData());
+  }
+  if(read_page) {
+    ReadPageIn(page_id, frame->GetData());
   } else {
-    if(!replacer_->Victim(ans)) return nullptr;
+    frame->ResetMemory();
+  }
+  lck.lock();
 
+  if(write_back || compress) flushing_.erase(old_page_id);
+  frame->EndWrite();
+  frame->io_in_progress_ = false;
+  io_cv_.notify_all();
+}
+
+/*
+ * Give a claimed frame that is getting a new page to partition. The hits of
+ * the page it held stay with the partition that held it, the history the
+ * replacer it goes to has of the frame is dropped.
+ * Caller must hold latch_
+ */
+void BufferPoolManager::AssignFrame(Page *frame, size_t partition) {
+  size_t frame_id = frame->frame_id_;
+  partitions_[frames_.partition_ids_[frame_id]]->num_hits_ +=
+      frame->hit_count_ - frames_.load_hit_counts_[frame_id];
+  frames_.load_hit_counts_[frame_id] = frame->hit_count_;
+  frames_.partition_ids_[frame_id] = static_cast<uint8_t>(partition);
+  frames_.priorities_[frame_id] = static_cast<uint8_t>(PagePriority::LOW);
+  partitions_[partition]->num_frames_++;
+  GetFrameReplacer(frame)->Reset(frame);
+}
+
+BufferPoolPartition *BufferPoolManager::CreatePartition(const std::string &name,
+                                                        size_t min_frames,
+                                                        size_t max_frames) {
+  std::lock_guard<std::mutex> lck(latch_);
+  size_t num_partitions = num_partitions_;
+  size_t min_total = min_frames;
+  for(size_t i = 1; i < num_partitions; ++i) {
+    if(partitions_[i]->name_ == name) return partitions_[i]->view_;
+    min_total += partitions_[i]->min_frames_;
   }
-  assert(ans->GetPinCount() == 0);
+  if(num_partitions == BUFFER_POOL_MAX_PARTITIONS)
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                    "too many buffer pool partitions");
+  if(min_total > pool_size_)
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                    "buffer pool partitions do not fit into the pool");
+  if(max_frames == 0 || max_frames > capacity_) max_frames = capacity_;
+  if(max_frames < min_frames) max_frames = min_frames;
 
-  page_id = disk_manager_->AllocatePage();  //call disk manager to allocate a page
-  if(ans->is_dirty_) {
-    //write it back to disk
-    disk_manager_->WritePage(ans->page_id_, ans->GetData());
+  BufferPoolPartition *view = new BufferPoolPartition(
+      name, min_frames, max_frames,
+      {BufferPoolPartition::Share{this, num_partitions}});
+  partitions_[num_partitions] =
+      NewPartition(name, min_frames, max_frames, view);
+  // the partition is complete before frames can be assigned to it
+  num_partitions_++;
+  return view;
+}
+
+BufferPoolPartition *BufferPoolManager::GetPartition(const std::string &name) {
+  std::lock_guard<std::mutex> lck(latch_);
+  for(size_t i = 1; i < num_partitions_; ++i) {
+    if(partitions_[i]->name_ == name) return partitions_[i]->view_;
   }
-  page_table_->Remove(ans->page_id_);
-  page_table_->Insert(page_id, ans);
-  
-  ans->page_id_ = page_id;
-  ans->pin_count_ = 1;
-  ans->is_dirty_ = false;
-  ans->ResetMemory();
+  return nullptr;
+}
 
-  return ans;
+std::vector<BufferPoolPartition *> BufferPoolManager::GetPartitions() {
+  std::lock_guard<std::mutex> lck(latch_);
+  std::vector<BufferPoolPartition *> views;
+  for(size_t i = 1; i < num_partitions_; ++i)
+    views.push_back(partitions_[i]->view_);
+  return views;
+}
+
+size_t BufferPoolManager::GetPartitionHits(size_t partition) {
+  std::lock_guard<std::mutex> lck(latch_);
+  size_t num_hits = partitions_[partition]->num_hits_;
+  for(size_t i = 0; i < capacity_; ++i) {
+    if(frames_.partition_ids_[i] == partition)
+      num_hits += frames_.hit_counts_[i] - frames_.load_hit_counts_[i];
+  }
+  return num_hits;
+}
+
+size_t BufferPoolManager::GetPartitionMisses(size_t partition) {
+  std::lock_guard<std::mutex> lck(latch_);
+  return partitions_[partition]->num_misses_;
+}
+
+size_t BufferPoolManager::GetPartitionFrames(size_t partition) {
+  std::lock_guard<std::mutex> lck(latch_);
+  return partitions_[partition]->num_frames_;
 }
 
 } // namespace scudb
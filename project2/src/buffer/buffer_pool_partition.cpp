@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cassert>
+
+#include "buffer/buffer_pool_partition.h"
+
+namespace scudb {
+
+/*
+ * BufferPoolPartition Constructor
+ * The frames are the pools' of the shares. A page is pinned through the
+ * pool that owns it, the instance picked by its page id in a parallel pool.
+ */
+BufferPoolPartition::BufferPoolPartition(const std::string &name,
+                                         size_t min_frames, size_t max_frames,
+                                         std::vector<Share> shares)
+    : name_(name), min_frames_(min_frames), max_frames_(max_frames),
+      shares_(std::move(shares)) {
+  assert(!shares_.empty());
+}
+
+const BufferPoolPartition::Share &
+BufferPoolPartition::GetShare(page_id_t page_id) const {
+  assert(page_id != INVALID_PAGE_ID);
+  return shares_[static_cast<size_t>(page_id) % shares_.size()];
+}
+
+Page *BufferPoolPartition::FetchPage(page_id_t page_id,
+                                     PagePriority priority) {
+  const Share &share = GetShare(page_id);
+  Page *page = share.pool_->PinPage(page_id, false, nullptr, share.partition_);
+  if (page != nullptr)
+    share.pool_->SetPriority(page, priority);
+  return page;
+}
+
+Page *BufferPoolPartition::FetchPage(page_id_t page_id, BufferRing *ring) {
+  const Share &share = GetShare(page_id);
+  return share.pool_->PinPage(page_id, false, ring, share.partition_);
+}
+
+Page *BufferPoolPartition::FetchPageOptimistic(page_id_t page_id,
+                                               uint64_t &version) {
+  return GetShare(page_id).pool_->FetchPageOptimistic(page_id, version);
+}
+
+Page *BufferPoolPartition::FetchChildOptimistic(Page *parent, int slot,
+                                                page_id_t child_page_id,
+                                                uint64_t &version) {
+  return GetShare(child_page_id)
+      .pool_->FetchChildOptimistic(parent, slot, child_page_id, version);
+}
+
+Page *BufferPoolPartition::FetchFrame(Page *frame, page_id_t page_id) {
+  const Share &share = GetShare(page_id);
+  return share.pool_->PinFrame(frame, page_id, share.partition_);
+}
+
+bool BufferPoolPartition::UnpinPage(page_id_t page_id, bool is_dirty,
+                                    PagePriority priority) {
+  if (page_id == INVALID_PAGE_ID)
+    return false;
+  return GetShare(page_id).pool_->UnpinPage(page_id, is_dirty, priority);
+}
+
+bool BufferPoolPartition::FlushPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID)
+    return false;
+  return GetShare(page_id).pool_->FlushPage(page_id);
+}
+
+Page *BufferPoolPartition::NewPage(page_id_t &page_id) {
+  return NewPage(page_id, nullptr);
+}
+
+/*
+ * With a single share the pool allocates the page id. Otherwise the id picks
+ * the share, so it is allocated first and given back if that share's pool
+ * has every frame pinned.
+ */
+Page *BufferPoolPartition::NewPage(page_id_t &page_id, Extent *extent) {
+  if (shares_.size() == 1)
+    return shares_[0].pool_->NewPageIn(page_id, shares_[0].partition_, extent);
+  return BufferPoolManager::NewPageRouted(
+      page_id, extent, shares_[0].pool_->disk_manager_,
+      [this](page_id_t new_page_id) {
+        const Share &share = GetShare(new_page_id);
+        return share.pool_->NewPageWithId(new_page_id, share.partition_);
+      });
+}
+
+bool BufferPoolPartition::DeletePage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID)
+    return false;
+  return GetShare(page_id).pool_->DeletePage(page_id);
+}
+
+// the read-ahead thread of the first page's pool walks the chain through the
+// partition, each page goes to its share
+void BufferPoolPartition::ReadAhead(page_id_t page_id,
+                                    NextPageFunc next_page) {
+  if (page_id == INVALID_PAGE_ID)
+    return;
+  GetShare(page_id).pool_->QueueReadAhead(page_id, std::move(next_page), this);
+}
+
+Page *BufferPoolPartition::PrefetchPage(page_id_t page_id) {
+  const Share &share = GetShare(page_id);
+  return share.pool_->PinPage(page_id, true, nullptr, share.partition_);
+}
+
+void BufferPoolPartition::ReleasePrefetched(Page *page) {
+  GetShare(page->GetPageId()).pool_->ReleasePrefetched(page);
+}
+
+size_t BufferPoolPartition::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto &share : shares_)
+    pool_size += share.pool_->GetPoolSize();
+  return std::min(max_frames_, pool_size);
+}
+
+size_t BufferPoolPartition::GetPageSize() const {
+  return shares_[0].pool_->GetPageSize();
+}
+
+size_t BufferPoolPartition::GetNumHits() {
+  size_t num_hits = 0;
+  for (auto &share : shares_)
+    num_hits += share.pool_->GetPartitionHits(share.partition_);
+  return num_hits;
+}
+
+size_t BufferPoolPartition::GetNumMisses() {
+  size_t num_misses = 0;
+  for (auto &share : shares_)
+    num_misses += share.pool_->GetPartitionMisses(share.partition_);
+  return num_misses;
+}
+
+size_t BufferPoolPartition::GetNumFrames() {
+  size_t num_frames = 0;
+  for (auto &share : shares_)
+    num_frames += share.pool_->GetPartitionFrames(share.partition_);
+  return num_frames;
+}
+
+double BufferPoolPartition::GetHitRatio() {
+  size_t num_hits = GetNumHits();
+  size_t num_accesses = num_hits + GetNumMisses();
+  return num_accesses == 0 ? 0 : static_cast<double>(num_hits) / num_accesses;
+}
+
+} // namespace scudb
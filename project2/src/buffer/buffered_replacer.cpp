@@ -0,0 +1,193 @@
+/**
+ * Buffered replacer implementation
+ */
+#include <cassert>
+#include <thread>
+
+#include "buffer/buffered_replacer.h"
+
+namespace scudb {
+
+// threads are spread over the stripes in the order they first record
+static size_t ThreadStripe() {
+  static std::atomic<size_t> next_thread(0);
+  thread_local size_t thread_index = next_thread++;
+  return thread_index;
+}
+
+template <typename T>
+BufferedReplacer<T>::BufferedReplacer(Replacer<T> *replacer,
+                                      size_t num_frames)
+    : replacer_(replacer), num_frames_(num_frames), values_(num_frames),
+      in_use_(new std::atomic<bool>[num_frames]),
+      stripes_(new Stripe[STRIPE_COUNT]) {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    in_use_[i].store(false);
+  }
+  for (size_t i = 0; i < STRIPE_COUNT; ++i) {
+    stripes_[i].head.store(0);
+    stripes_[i].tail.store(0);
+    for (size_t j = 0; j < STRIPE_SIZE; ++j) {
+      stripes_[i].slots[j].store(0);
+    }
+  }
+}
+
+template <typename T> BufferedReplacer<T>::~BufferedReplacer() {
+  delete replacer_;
+}
+
+/*
+ * Mark the frame evictable and buffer the access. The value is published
+ * before the slot, so the drainer always reads the right one.
+ */
+template <typename T> void BufferedReplacer<T>::Insert(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  values_[frame_id] = value;
+  in_use_[frame_id].store(true);
+  Record(frame_id + 1);
+}
+
+/*
+ * Apply everything buffered, then take victims from the wrapped replacer.
+ * It only holds a pinned frame if the pin is not recorded yet (Erase() is
+ * between clearing the flag and recording); such a frame is dropped here and
+ * comes back with its next Insert.
+ */
+template <typename T> bool BufferedReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lck(drain_latch_);
+  DrainAll();
+  T candidate;
+  while (replacer_->Victim(candidate)) {
+    bool expected = true;
+    if (in_use_[FrameIdOf(candidate)].compare_exchange_strong(expected,
+                                                              false)) {
+      value = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * The frame's flag is cleared at once, the wrapped replacer learns about it
+ * at the next drain. A frame that was not evictable records nothing, so
+ * repeated pins of a hot page cost one exchange.
+ * return true if the frame was evictable
+ */
+template <typename T> bool BufferedReplacer<T>::Erase(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  if (!in_use_[frame_id].exchange(false))
+    return false;
+  Record((frame_id + 1) | ERASE_FLAG);
+  return true;
+}
+
+/*
+ * Ask the wrapped policy, with every buffered access applied first
+ */
+template <typename T>
+bool BufferedReplacer<T>::PeekVictims(std::vector<T> &values, size_t max) {
+  std::lock_guard<std::mutex> lck(drain_latch_);
+  DrainAll();
+  std::vector<T> candidates;
+  if (!replacer_->PeekVictims(candidates, max))
+    return false;
+  for (auto &candidate : candidates) {
+    if (in_use_[FrameIdOf(candidate)].load())
+      values.push_back(candidate);
+  }
+  return true;
+}
+
+template <typename T> void BufferedReplacer<T>::Reinsert(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  bool expected = false;
+  values_[frame_id] = value;
+  if (in_use_[frame_id].compare_exchange_strong(expected, true))
+    Record(frame_id + 1);
+}
+
+template <typename T> void BufferedReplacer<T>::Reset(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  std::lock_guard<std::mutex> lck(drain_latch_);
+  DrainAll();
+  in_use_[frame_id].store(false);
+  replacer_->Reset(value);
+}
+
+template <typename T> size_t BufferedReplacer<T>::Size() {
+  size_t size = 0;
+  for (size_t i = 0; i < num_frames_; ++i) {
+    if (in_use_[i].load())
+      size++;
+  }
+  return size;
+}
+
+/*
+ * Reserve a slot with a CAS on tail, waiting for a drain only when the stripe
+ * is full. The thread that fills the stripe drains everything if nobody else
+ * is draining already.
+ */
+template <typename T> void BufferedReplacer<T>::Record(size_t slot) {
+  Stripe &stripe = stripes_[ThreadStripe() % STRIPE_COUNT];
+  size_t tail = stripe.tail.load();
+  while (true) {
+    if (tail - stripe.head.load() >= STRIPE_SIZE) {
+      std::lock_guard<std::mutex> lck(drain_latch_);
+      DrainStripe(stripe);
+      tail = stripe.tail.load();
+      continue;
+    }
+    if (stripe.tail.compare_exchange_weak(tail, tail + 1))
+      break;
+  }
+  stripe.slots[tail % STRIPE_SIZE].store(slot);
+
+  if (tail + 1 - stripe.head.load() >= STRIPE_SIZE && drain_latch_.try_lock()) {
+    DrainAll();
+    drain_latch_.unlock();
+  }
+}
+
+/*
+ * Every access reaches the wrapped policy, also one of a frame that is pinned
+ * again by now: it is erased right after. Stripes of different threads may
+ * hold the changes of a frame out of order, so a pin is only applied if the
+ * flag still agrees with it; that leaves the wrapped replacer with the
+ * latest state either way.
+ */
+template <typename T> void BufferedReplacer<T>::DrainStripe(Stripe &stripe) {
+  size_t head = stripe.head.load();
+  size_t tail = stripe.tail.load();
+  for (; head != tail; ++head) {
+    size_t slot;
+    // the writer reserved the slot but has not stored into it yet
+    while ((slot = stripe.slots[head % STRIPE_SIZE].exchange(0)) == 0)
+      std::this_thread::yield();
+    size_t frame_id = (slot & ~ERASE_FLAG) - 1;
+    bool in_use = in_use_[frame_id].load();
+    if (!(slot & ERASE_FLAG))
+      replacer_->Insert(values_[frame_id]);
+    if (!in_use)
+      replacer_->Erase(values_[frame_id]);
+  }
+  stripe.head.store(tail);
+}
+
+template <typename T> void BufferedReplacer<T>::DrainAll() {
+  for (size_t i = 0; i < STRIPE_COUNT; ++i) {
+    DrainStripe(stripes_[i]);
+  }
+}
+
+template class BufferedReplacer<Page *>;
+// test only
+template class BufferedReplacer<int>;
+
+} // namespace scudb
@@ -0,0 +1,101 @@
+/**
+ * CLOCK implementation
+ */
+#include <cassert>
+
+#include "buffer/clock_replacer.h"
+
+namespace scudb {
+
+template <typename T>
+ClockReplacer<T>::ClockReplacer(size_t num_frames)
+    : num_frames_(num_frames), values_(num_frames),
+      in_use_(new std::atomic<bool>[num_frames]),
+      ref_(new std::atomic<bool>[num_frames]), size_(0), hand_(0) {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    in_use_[i].store(false);
+    ref_[i].store(false);
+  }
+}
+
+template <typename T> ClockReplacer<T>::~ClockReplacer() {}
+
+/*
+ * Make the frame evictable and give it a second chance.
+ * The value is published before the in_use flag, so a sweeper that claims
+ * the flag always reads the right value.
+ */
+template <typename T> void ClockReplacer<T>::Insert(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  values_[frame_id] = value;
+  ref_[frame_id].store(true, std::memory_order_relaxed);
+  if (!in_use_[frame_id].exchange(true))
+    size_++;
+}
+
+/*
+ * Sweep the clock hand: frames with the reference bit set have it cleared
+ * and are skipped once, the first frame found with a clear bit is evicted.
+ */
+template <typename T> bool ClockReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lck(latch_);
+  while (size_.load() > 0) {
+    size_t frame_id = hand_;
+    hand_ = (hand_ + 1) % num_frames_;
+    if (!in_use_[frame_id].load())
+      continue;
+    if (ref_[frame_id].exchange(false, std::memory_order_relaxed))
+      continue;
+    bool expected = true;
+    // lose the race against a concurrent Erase: keep sweeping
+    if (in_use_[frame_id].compare_exchange_strong(expected, false)) {
+      size_--;
+      value = values_[frame_id];
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Remove value from the candidates. return true if it was evictable
+ */
+template <typename T> bool ClockReplacer<T>::Erase(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  if (in_use_[frame_id].exchange(false)) {
+    size_--;
+    return true;
+  }
+  return false;
+}
+
+template <typename T> size_t ClockReplacer<T>::Size() { return size_.load(); }
+
+/*
+ * One lap of the hand without touching the bits: frames whose reference bit
+ * is clear go first, in hand order, then the referenced ones
+ */
+template <typename T>
+bool ClockReplacer<T>::PeekVictims(std::vector<T> &values, size_t max) {
+  std::lock_guard<std::mutex> lck(latch_);
+  size_t start = values.size();
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < num_frames_; ++i) {
+      if (values.size() - start == max)
+        return true;
+      size_t frame_id = (hand_ + i) % num_frames_;
+      if (in_use_[frame_id].load() &&
+          ref_[frame_id].load(std::memory_order_relaxed) == (pass == 1))
+        values.push_back(values_[frame_id]);
+    }
+  }
+  return true;
+}
+
+template class ClockReplacer<Page *>;
+// test only
+template class ClockReplacer<int>;
+
+} // namespace scudb
@@ -0,0 +1,96 @@
+/**
+ * compressed_cache.cpp
+ */
+
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "buffer/compressed_cache.h"
+#include "buffer/page_compressor.h"
+
+namespace scudb {
+
+CompressedCache::CompressedCache(size_t budget, size_t page_size)
+    : budget_(budget), page_size_(page_size), memory_usage_(0), num_hits_(0),
+      num_misses_(0), num_evictions_(0), num_rejected_(0) {}
+
+/*
+ * Compress without the latch, then make room for the page by evicting from
+ * the least recently stored end
+ */
+bool CompressedCache::Put(page_id_t page_id, const char *page_data) {
+  size_t capacity = page_size_ - page_size_ / COMPRESSED_CACHE_MIN_SAVING;
+  std::unique_ptr<char[]> buffer(new char[capacity]);
+  size_t size =
+      PageCompressor::Compress(page_data, page_size_, buffer.get(), capacity);
+  Entry entry{page_id, size, nullptr};
+  if (size == 0 || EntryMemory(entry) > budget_) {
+    num_rejected_++;
+    Erase(page_id);
+    return false;
+  }
+  entry.data.reset(new char[size]);
+  memcpy(entry.data.get(), buffer.get(), size);
+
+  std::lock_guard<std::mutex> lck(latch_);
+  auto old_entry = entries_.find(page_id);
+  if (old_entry != entries_.end())
+    RemoveEntry(old_entry->second);
+  while (memory_usage_ + EntryMemory(entry) > budget_) {
+    RemoveEntry(std::prev(lru_.end()));
+    num_evictions_++;
+  }
+  memory_usage_ += EntryMemory(entry);
+  lru_.push_front(std::move(entry));
+  entries_[page_id] = lru_.begin();
+  return true;
+}
+
+bool CompressedCache::Get(page_id_t page_id, char *page_data) {
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lck(latch_);
+    auto found = entries_.find(page_id);
+    if (found == entries_.end()) {
+      num_misses_++;
+      return false;
+    }
+    entry = std::move(*found->second);
+    memory_usage_ -= EntryMemory(entry);
+    lru_.erase(found->second);
+    entries_.erase(found);
+  }
+  if (!PageCompressor::Decompress(entry.data.get(), entry.size, page_data,
+                                  page_size_)) {
+    num_misses_++;
+    return false;
+  }
+  num_hits_++;
+  return true;
+}
+
+void CompressedCache::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> lck(latch_);
+  auto found = entries_.find(page_id);
+  if (found != entries_.end())
+    RemoveEntry(found->second);
+}
+
+size_t CompressedCache::GetMemoryUsage() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return memory_usage_;
+}
+
+size_t CompressedCache::GetNumPages() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return entries_.size();
+}
+
+void CompressedCache::RemoveEntry(std::list<Entry>::iterator entry) {
+  memory_usage_ -= EntryMemory(*entry);
+  entries_.erase(entry->page_id);
+  lru_.erase(entry);
+}
+
+} // namespace scudb
@@ -0,0 +1,61 @@
+/**
+ * frame_arena.cpp
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+#include "buffer/frame_arena.h"
+#include "common/config.h"
+
+namespace scudb {
+
+/*
+ * Try explicit huge pages first when ARENA_HUGETLB is on (they have to be
+ * reserved by the administrator), then fall back to normal pages, asking for
+ * transparent huge pages if the arena spans at least one.
+ */
+FrameArena::FrameArena(size_t size)
+    : data_(nullptr), size_(size), mapped_size_(0), huge_pages_(false) {
+  if (size_ == 0)
+    return;
+  void *data = MAP_FAILED;
+#if ARENA_HUGETLB && defined(MAP_HUGETLB)
+  size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE *
+                     HUGE_PAGE_SIZE;
+  data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (data != MAP_FAILED) {
+    mapped_size_ = huge_size;
+    huge_pages_ = true;
+  }
+#endif
+  if (data == MAP_FAILED) {
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED)
+      throw std::bad_alloc();
+    mapped_size_ = size_;
+#ifdef MADV_HUGEPAGE
+    if (ARENA_HUGE_PAGES && size_ >= HUGE_PAGE_SIZE)
+      huge_pages_ = madvise(data, size_, MADV_HUGEPAGE) == 0;
+#endif
+  }
+  // anonymous mappings are zero filled
+  data_ = static_cast<char *>(data);
+}
+
+bool FrameArena::Release(size_t offset, size_t size) {
+  if (size == 0 || offset + size > size_)
+    return false;
+  return madvise(data_ + offset, size, MADV_DONTNEED) == 0;
+}
+
+FrameArena::~FrameArena() {
+  if (data_ != nullptr)
+    munmap(data_, mapped_size_);
+}
+
+} // namespace scudb
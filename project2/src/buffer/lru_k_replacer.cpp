@@ -0,0 +1,113 @@
+/**
+ * LRU-K implementation
+ */
+#include <cassert>
+
+#include "buffer/lru_k_replacer.h"
+
+namespace scudb {
+
+template <typename T>
+LRUKReplacer<T>::LRUKReplacer(size_t num_frames, size_t k)
+    : num_frames_(num_frames), k_(k), current_timestamp_(0), size_(0),
+      values_(num_frames), in_use_(num_frames, false), count_(num_frames, 0),
+      history_(num_frames * k, 0) {
+  assert(k_ > 0);
+}
+
+template <typename T> LRUKReplacer<T>::~LRUKReplacer() {}
+
+/*
+ * Record an access for the frame and make it evictable
+ */
+template <typename T> void LRUKReplacer<T>::Insert(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  std::lock_guard<std::mutex> lck(latch_);
+  History(frame_id, count_[frame_id]++) = current_timestamp_++;
+  values_[frame_id] = value;
+  if (!in_use_[frame_id]) {
+    in_use_[frame_id] = true;
+    size_++;
+  }
+}
+
+/*
+ * Evict the frame with the largest backward K-distance. Its access history is
+ * dropped, the next page loaded into the frame starts from scratch.
+ */
+template <typename T> bool LRUKReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lck(latch_);
+  if (size_ == 0)
+    return false;
+
+  bool found_infinite = false;
+  size_t victim = num_frames_;
+  size_t victim_timestamp = 0;
+  for (size_t frame_id = 0; frame_id < num_frames_; ++frame_id) {
+    if (!in_use_[frame_id])
+      continue;
+    size_t count = count_[frame_id];
+    bool infinite = count < k_;
+    // +inf distance: compare by last access; otherwise by K-th last access
+    size_t timestamp = infinite ? History(frame_id, count - 1)
+                                : History(frame_id, count - k_);
+    if (found_infinite && !infinite)
+      continue;
+    if (victim == num_frames_ || (infinite && !found_infinite) ||
+        timestamp < victim_timestamp) {
+      victim = frame_id;
+      victim_timestamp = timestamp;
+      found_infinite = infinite;
+    }
+  }
+  assert(victim != num_frames_);
+
+  in_use_[victim] = false;
+  count_[victim] = 0;
+  size_--;
+  value = values_[victim];
+  return true;
+}
+
+/*
+ * Remove value from the candidates, e.g. because it was pinned again. Its
+ * history is kept: the page is still resident and the access that pinned it
+ * will be recorded when it is unpinned. return true if it was evictable
+ */
+template <typename T> bool LRUKReplacer<T>::Erase(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  std::lock_guard<std::mutex> lck(latch_);
+  if (!in_use_[frame_id])
+    return false;
+  in_use_[frame_id] = false;
+  size_--;
+  return true;
+}
+
+/*
+ * Any path handing the frame another page goes through here, not only
+ * Victim(): the new page starts without history
+ */
+template <typename T> void LRUKReplacer<T>::Reset(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
+  std::lock_guard<std::mutex> lck(latch_);
+  if (in_use_[frame_id]) {
+    in_use_[frame_id] = false;
+    size_--;
+  }
+  count_[frame_id] = 0;
+}
+
+template <typename T> size_t LRUKReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return size_;
+}
+
+template class LRUKReplacer<Page *>;
+// test only
+template class LRUKReplacer<int>;
+
+} // namespace scudb
@@ -1,49 +1,43 @@
 /**
  * LRU implementation
  */
+#include <cassert>
+
 #include "buffer/lru_replacer.h"
 #include "page/page.h"
 
 namespace scudb {
 
-template <typename T> LRUReplacer<T>::LRUReplacer() : pSize(0) {
-  head = new node();
-  tail = new node();
-  head->next = tail;
-  tail->prev = head;
-}
+template <typename T>
+LRUReplacer<T>::LRUReplacer(size_t num_frames)
+    : num_frames_(num_frames), prev_(num_frames + 1, num_frames),
+      next_(num_frames + 1, num_frames), in_list_(num_frames, false),
+      values_(num_frames), size_(0) {}
 
-/*
- * In this task, I am peimitted that I could assume I will not run out of memory
- * So there is no 'actual' implement with deconstructor
- */
 template <typename T> LRUReplacer<T>::~LRUReplacer() {}
 
 /*
- * Insert value into LRU
+ * Insert value into LRU, as the most recently used one
  */
 template <typename T> void LRUReplacer<T>::Insert(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
   std::lock_guard<std::mutex> lck(mtx);
-  node* temp;
-  if(pages.find(value) == pages.end()) {
-    //之前没有出现过的page，要新加入则new一个节点以记录其信息
-    temp = new node(value);
-    pSize++;
+  if (in_list_[frame_id]) {
+    Unlink(frame_id);
   } else {
-    //之前用过的page再被提及到，则找到这个节点
-    temp = pages[value];
-    node* pre = temp->prev;
-    node* nxt = temp->next;
-    pre->next = nxt;
-    nxt->prev = pre;
+    in_list_[frame_id] = true;
+    size_++;
   }
-  //把最新的节点放在队首
-  node* first = head->next;
-  temp->next = first;
-  first->prev = temp;
-  temp->prev = head;
-  head->next = temp;
-  pages[value] = temp;
+  values_[frame_id] = value;
+
+  // link right after the head sentinel
+  size_t head = num_frames_;
+  size_t first = next_[head];
+  next_[frame_id] = first;
+  prev_[frame_id] = head;
+  prev_[first] = frame_id;
+  next_[head] = frame_id;
 }
 
 /* If LRU is non-empty, pop the head member from LRU to argument "value", and
@@ -51,16 +45,14 @@ template <typename T> void LRUReplacer<T>::Insert(const T &value) {
  */
 template <typename T> bool LRUReplacer<T>::Victim(T &value) {
   std::lock_guard<std::mutex> lck(mtx);
-  // If LRU is empty, return false
-  if(pSize == 0) return false;
-  // If LRU is non-empty
-  //目前在队尾的节点是least-recently used
-  node* temp = tail->prev;
-  value = temp->data;
-  tail->prev = temp->prev;
-  temp->prev->next = tail;
-  pages.erase(temp->data);
-  pSize--;
+  if (size_ == 0)
+    return false;
+  // the frame before the sentinel is the least recently used one
+  size_t frame_id = prev_[num_frames_];
+  Unlink(frame_id);
+  in_list_[frame_id] = false;
+  size_--;
+  value = values_[frame_id];
   return true;
 }
 
@@ -69,19 +61,39 @@ template <typename T> bool LRUReplacer<T>::Victim(T &value) {
  * return false
  */
 template <typename T> bool LRUReplacer<T>::Erase(const T &value) {
+  size_t frame_id = FrameIdOf(value);
+  assert(frame_id < num_frames_);
   std::lock_guard<std::mutex> lck(mtx);
-  if(pages.find(value) != pages.end()) {
-    node* temp = pages[value];
-    temp->prev->next = temp->next;
-    temp->next->prev = temp->prev;
-    pSize--;
-  }
-  return pages.erase(value);
+  if (!in_list_[frame_id])
+    return false;
+  Unlink(frame_id);
+  in_list_[frame_id] = false;
+  size_--;
+  return true;
+}
+
+template <typename T> size_t LRUReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lck(mtx);
+  return size_;
 }
 
-template <typename T> size_t LRUReplacer<T>::Size() { 
+/*
+ * Walk from the least recently used end
+ */
+template <typename T>
+bool LRUReplacer<T>::PeekVictims(std::vector<T> &values, size_t max) {
   std::lock_guard<std::mutex> lck(mtx);
-  return pSize; 
+  size_t frame_id = prev_[num_frames_];
+  for (size_t i = 0; i < max && frame_id != num_frames_; ++i) {
+    values.push_back(values_[frame_id]);
+    frame_id = prev_[frame_id];
+  }
+  return true;
+}
+
+template <typename T> void LRUReplacer<T>::Unlink(size_t frame_id) {
+  next_[prev_[frame_id]] = next_[frame_id];
+  prev_[next_[frame_id]] = prev_[frame_id];
 }
 
 template class LRUReplacer<Page *>;
@@ -0,0 +1,160 @@
+/**
+ * page_compressor.cpp
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "buffer/page_compressor.h"
+
+namespace scudb {
+
+namespace {
+
+inline uint32_t Read32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline size_t Hash(uint32_t value, size_t bits) {
+  return (value * 2654435761U) >> (32 - bits);
+}
+
+// length above 15 as extra bytes, false if out of room
+inline bool WriteLength(size_t length, uint8_t *&out, const uint8_t *out_end) {
+  for (; length >= 255; length -= 255) {
+    if (out >= out_end)
+      return false;
+    *out++ = 255;
+  }
+  if (out >= out_end)
+    return false;
+  *out++ = static_cast<uint8_t>(length);
+  return true;
+}
+
+inline bool ReadLength(size_t &length, const uint8_t *&in,
+                       const uint8_t *in_end) {
+  uint8_t byte;
+  do {
+    if (in >= in_end)
+      return false;
+    byte = *in++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// one sequence: literals [literal, literal + literal_length), then a match
+// of match_length at offset unless match_length is 0 (the last sequence)
+bool WriteSequence(const uint8_t *literal, size_t literal_length,
+                   size_t offset, size_t match_length, uint8_t *&out,
+                   const uint8_t *out_end) {
+  if (out >= out_end)
+    return false;
+  size_t match_code = match_length == 0 ? 0 : match_length - 4;
+  uint8_t *token = out++;
+  *token = static_cast<uint8_t>(
+      (literal_length < 15 ? literal_length : 15) << 4 |
+      (match_code < 15 ? match_code : 15));
+  if (literal_length >= 15 && !WriteLength(literal_length - 15, out, out_end))
+    return false;
+  if (static_cast<size_t>(out_end - out) < literal_length)
+    return false;
+  memcpy(out, literal, literal_length);
+  out += literal_length;
+  if (match_length == 0)
+    return true;
+  if (out_end - out < 2)
+    return false;
+  *out++ = static_cast<uint8_t>(offset);
+  *out++ = static_cast<uint8_t>(offset >> 8);
+  return match_code < 15 || WriteLength(match_code - 15, out, out_end);
+}
+
+} // namespace
+
+/*
+ * Greedy parse: take the first match the hash table offers. The search step
+ * grows while no match is found, so data that does not compress is skipped
+ * through quickly.
+ */
+size_t PageCompressor::Compress(const char *src, size_t size, char *dst,
+                                size_t capacity) {
+  const uint8_t *in = reinterpret_cast<const uint8_t *>(src);
+  uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *out_end = out + capacity;
+  // position + 1 of the last 4 byte prefix with this hash, 0 if none
+  uint32_t table[1 << HASH_BITS] = {0};
+  size_t anchor = 0;
+  size_t pos = 0;
+  size_t misses = 0;
+  while (pos + MIN_MATCH <= size) {
+    uint32_t prefix = Read32(in + pos);
+    size_t slot = Hash(prefix, HASH_BITS);
+    size_t candidate = table[slot];
+    table[slot] = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET ||
+        Read32(in + candidate - 1) != prefix) {
+      pos += 1 + (misses++ >> 5);
+      continue;
+    }
+    candidate--;
+    size_t length = MIN_MATCH;
+    while (pos + length < size && in[candidate + length] == in[pos + length])
+      length++;
+    if (!WriteSequence(in + anchor, pos - anchor, pos - candidate, length, out,
+                       out_end))
+      return 0;
+    pos += length;
+    anchor = pos;
+    misses = 0;
+  }
+  if (!WriteSequence(in + anchor, size - anchor, 0, 0, out, out_end))
+    return 0;
+  return out - reinterpret_cast<uint8_t *>(dst);
+}
+
+bool PageCompressor::Decompress(const char *src, size_t size, char *dst,
+                                size_t dst_size) {
+  const uint8_t *in = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *in_end = in + size;
+  uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+  uint8_t *out_begin = out;
+  const uint8_t *out_end = out + dst_size;
+  while (in < in_end) {
+    uint8_t token = *in++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(literal_length, in, in_end))
+      return false;
+    if (static_cast<size_t>(in_end - in) < literal_length ||
+        static_cast<size_t>(out_end - out) < literal_length)
+      return false;
+    memcpy(out, in, literal_length);
+    in += literal_length;
+    out += literal_length;
+    // the last sequence ends with its literals
+    if (in == in_end)
+      break;
+    if (in_end - in < 2)
+      return false;
+    size_t offset = in[0] | static_cast<size_t>(in[1]) << 8;
+    in += 2;
+    size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLength(match_length, in, in_end))
+      return false;
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(out - out_begin) ||
+        static_cast<size_t>(out_end - out) < match_length)
+      return false;
+    // the match may overlap what it produces, copy byte by byte
+    const uint8_t *match = out - offset;
+    for (size_t i = 0; i < match_length; ++i)
+      out[i] = match[i];
+    out += match_length;
+  }
+  return out == out_end;
+}
+
+} // namespace scudb
@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <cassert>
+
+#include "buffer/buffer_pool_partition.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+
+namespace scudb {
+
+/*
+ * ParallelBufferPoolManager Constructor
+ * All the frames belong to the instances. If pool_size does not divide evenly, the first instances get one
+ * extra frame each.
+ */
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances,
+                                                     size_t pool_size,
+                                                     DiskManager *disk_manager,
+                                                     LogManager *log_manager,
+                                                     ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : disk_manager_(disk_manager), prefetch_window_(PREFETCH_WINDOW),
+      image_thread_(nullptr), image_running_(false), warm_up_time_(0) {
+  assert(num_instances > 0);
+  instances_.resize(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_[i] = new BufferPoolManager(
+        GetShare(pool_size, i), disk_manager, log_manager, replacer_type,
+        GetShare(max_pool_size, i));
+  }
+}
+
+size_t ParallelBufferPoolManager::GetShare(size_t num_frames, size_t i) const {
+  return num_frames / instances_.size() +
+         (i < num_frames % instances_.size() ? 1 : 0);
+}
+
+/*
+ * ParallelBufferPoolManager Deconstructor
+ * The threads of every instance may still pin pages through the partitions
+ * or through this pool, they are stopped before anything goes.
+ */
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  StopWriterThread();
+  StopPrefetchThread();
+  for (auto partition : partitions_) {
+    delete partition;
+  }
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+BufferPoolManager *ParallelBufferPoolManager::GetInstance(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  return instances_[static_cast<size_t>(page_id) % instances_.size()];
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id,
+                                           PagePriority priority) {
+  return GetInstance(page_id)->FetchPage(page_id, priority);
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id,
+                                           BufferRing *ring) {
+  return GetInstance(page_id)->FetchPage(page_id, ring);
+}
+
+Page *ParallelBufferPoolManager::FetchPageOptimistic(page_id_t page_id,
+                                                     uint64_t &version) {
+  return GetInstance(page_id)->FetchPageOptimistic(page_id, version);
+}
+
+Page *ParallelBufferPoolManager::FetchChildOptimistic(Page *parent, int slot,
+                                                      page_id_t child_page_id,
+                                                      uint64_t &version) {
+  return GetInstance(child_page_id)
+      ->FetchChildOptimistic(parent, slot, child_page_id, version);
+}
+
+Page *ParallelBufferPoolManager::FetchFrame(Page *frame, page_id_t page_id) {
+  return GetInstance(page_id)->FetchFrame(frame, page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty,
+                                          PagePriority priority) {
+  if (page_id == INVALID_PAGE_ID)
+    return false;
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty, priority);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID)
+    return false;
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  return NewPage(page_id, nullptr);
+}
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id, Extent *extent) {
+  return BufferPoolManager::NewPageRouted(
+      page_id, extent, disk_manager_, [this](page_id_t new_page_id) {
+        return GetInstance(new_page_id)->NewPageWithId(new_page_id);
+      });
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID)
+    return false;
+  return GetInstance(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::ReadAhead(page_id_t page_id,
+                                          NextPageFunc next_page) {
+  if (page_id == INVALID_PAGE_ID)
+    return;
+  GetInstance(page_id)->QueueReadAhead(page_id, std::move(next_page), this);
+}
+
+Page *ParallelBufferPoolManager::PrefetchPage(page_id_t page_id) {
+  return GetInstance(page_id)->PrefetchPage(page_id);
+}
+
+void ParallelBufferPoolManager::ReleasePrefetched(Page *page) {
+  GetInstance(page->GetPageId())->ReleasePrefetched(page);
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto instance : instances_)
+    pool_size += instance->GetPoolSize();
+  return pool_size;
+}
+
+size_t ParallelBufferPoolManager::GetNumHits() {
+  size_t num_hits = 0;
+  for (auto instance : instances_)
+    num_hits += instance->GetNumHits();
+  return num_hits;
+}
+
+size_t ParallelBufferPoolManager::GetMaxPoolSize() {
+  size_t max_pool_size = 0;
+  for (auto instance : instances_)
+    max_pool_size += instance->GetMaxPoolSize();
+  return max_pool_size;
+}
+
+size_t ParallelBufferPoolManager::GetMemoryUsage() {
+  size_t memory_usage = 0;
+  for (auto instance : instances_)
+    memory_usage += instance->GetMemoryUsage();
+  return memory_usage;
+}
+
+size_t ParallelBufferPoolManager::GetPageSize() const {
+  return disk_manager_->GetPageSize();
+}
+
+void ParallelBufferPoolManager::Resize(size_t new_size) {
+  for (size_t i = 0; i < instances_.size(); ++i)
+    instances_[i]->Resize(GetShare(new_size, i));
+}
+
+void ParallelBufferPoolManager::EnableCompressedCache(size_t budget) {
+  for (size_t i = 0; i < instances_.size(); ++i)
+    instances_[i]->EnableCompressedCache(GetShare(budget, i));
+}
+
+size_t ParallelBufferPoolManager::GetNumCompressedHits() {
+  size_t num_hits = 0;
+  for (auto instance : instances_)
+    num_hits += instance->GetNumCompressedHits();
+  return num_hits;
+}
+
+size_t ParallelBufferPoolManager::GetNumCompressedMisses() {
+  size_t num_misses = 0;
+  for (auto instance : instances_)
+    num_misses += instance->GetNumCompressedMisses();
+  return num_misses;
+}
+
+void ParallelBufferPoolManager::EnableSharedCache(const std::string &name,
+                                                  size_t num_pages) {
+  for (auto instance : instances_)
+    instance->EnableSharedCache(name, num_pages);
+}
+
+size_t ParallelBufferPoolManager::GetNumSharedHits() {
+  size_t num_hits = 0;
+  for (auto instance : instances_)
+    num_hits += instance->GetNumSharedHits();
+  return num_hits;
+}
+
+size_t ParallelBufferPoolManager::GetNumSharedMisses() {
+  size_t num_misses = 0;
+  for (auto instance : instances_)
+    num_misses += instance->GetNumSharedMisses();
+  return num_misses;
+}
+
+size_t ParallelBufferPoolManager::GetNumSwizzleHits() {
+  size_t num_hits = 0;
+  for (auto instance : instances_)
+    num_hits += instance->GetNumSwizzleHits();
+  return num_hits;
+}
+
+size_t ParallelBufferPoolManager::GetNumMisses() {
+  size_t num_misses = 0;
+  for (auto instance : instances_)
+    num_misses += instance->GetNumMisses();
+  return num_misses;
+}
+
+/*
+ * Start the writer of every instance, and a thread saving the warm-up image
+ * of the whole pool every WARM_IMAGE_DELAY; the instances have no image file
+ * of their own.
+ */
+void ParallelBufferPoolManager::RunWriterThread() {
+  for (auto instance : instances_)
+    instance->RunWriterThread();
+  std::lock_guard<std::mutex> lck(image_latch_);
+  if (image_thread_ != nullptr)
+    return;
+  image_running_ = true;
+  image_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> image_lck(image_latch_);
+    while (!image_cv_.wait_for(image_lck, WARM_IMAGE_DELAY,
+                               [this] { return !image_running_; })) {
+      std::string image_file = warm_image_file_;
+      if (image_file.empty())
+        continue;
+      image_lck.unlock();
+      SaveWarmImage(image_file);
+      image_lck.lock();
+    }
+  });
+}
+
+/*
+ * Stop the writers and the image thread, then save the last image before a
+ * shutdown
+ */
+void ParallelBufferPoolManager::StopWriterThread() {
+  std::thread *image_thread;
+  {
+    std::lock_guard<std::mutex> lck(image_latch_);
+    image_running_ = false;
+    image_thread = image_thread_;
+    image_thread_ = nullptr;
+  }
+  if (image_thread != nullptr) {
+    image_cv_.notify_one();
+    image_thread->join();
+    delete image_thread;
+  }
+  for (auto instance : instances_)
+    instance->StopWriterThread();
+  if (image_thread == nullptr)
+    return;
+  std::string image_file;
+  {
+    std::lock_guard<std::mutex> lck(image_latch_);
+    image_file = warm_image_file_;
+  }
+  if (!image_file.empty())
+    SaveWarmImage(image_file);
+}
+
+void ParallelBufferPoolManager::SetWarmImageFile(const std::string &file_name) {
+  std::lock_guard<std::mutex> lck(image_latch_);
+  warm_image_file_ = file_name;
+}
+
+bool ParallelBufferPoolManager::SaveWarmImage(const std::string &file_name) {
+  std::vector<WarmPage> pages;
+  for (auto instance : instances_)
+    instance->GetResidentPages(pages);
+  return BufferPoolManager::WriteWarmImage(file_name, GetPageSize(), pages);
+}
+
+size_t ParallelBufferPoolManager::WarmUp(const std::string &file_name) {
+  auto start = std::chrono::steady_clock::now();
+  size_t num_warmed = BufferPoolManager::LoadWarmImage(
+      file_name, GetPageSize(), GetPoolSize(), disk_manager_,
+      [this](page_id_t page_id, const char *page_data) {
+        return GetInstance(page_id)->InstallPage(page_id, page_data);
+      },
+      this);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  warm_up_time_ = elapsed.count();
+  return num_warmed;
+}
+
+size_t ParallelBufferPoolManager::GetNumPagesCleaned() {
+  size_t num_pages_cleaned = 0;
+  for (auto instance : instances_)
+    num_pages_cleaned += instance->GetNumPagesCleaned();
+  return num_pages_cleaned;
+}
+
+double ParallelBufferPoolManager::GetWriterFlushRate() {
+  double flush_rate = 0;
+  for (auto instance : instances_)
+    flush_rate += instance->GetWriterFlushRate();
+  return flush_rate;
+}
+
+size_t ParallelBufferPoolManager::GetNumForegroundWrites() {
+  size_t num_foreground_writes = 0;
+  for (auto instance : instances_)
+    num_foreground_writes += instance->GetNumForegroundWrites();
+  return num_foreground_writes;
+}
+
+void ParallelBufferPoolManager::SetPrefetchWindow(size_t window) {
+  prefetch_window_ = window;
+  for (auto instance : instances_)
+    instance->SetPrefetchWindow(window);
+}
+
+size_t ParallelBufferPoolManager::GetNumPrefetched() {
+  size_t num_prefetched = 0;
+  for (auto instance : instances_)
+    num_prefetched += instance->GetNumPrefetched();
+  return num_prefetched;
+}
+
+void ParallelBufferPoolManager::StopPrefetchThread() {
+  for (auto instance : instances_)
+    instance->StopPrefetchThread();
+}
+
+/*
+ * Every instance gets a partition of the name, the spanning partition is
+ * made of them. A max_frames share of 0 would mean no limit, an instance
+ * gets at least one frame then
+ */
+BufferPoolPartition *
+ParallelBufferPoolManager::CreatePartition(const std::string &name,
+                                           size_t min_frames,
+                                           size_t max_frames) {
+  std::lock_guard<std::mutex> lck(latch_);
+  for (auto partition : partitions_) {
+    if (partition->GetName() == name)
+      return partition;
+  }
+
+  std::vector<BufferPoolPartition::Share> shares;
+  size_t max_total = 0;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    size_t max_share =
+        max_frames == 0 ? 0 : std::max<size_t>(GetShare(max_frames, i), 1);
+    BufferPoolPartition *share = instances_[i]->CreatePartition(
+        name, GetShare(min_frames, i), max_share);
+    // its only share is the partition of the instance
+    shares.push_back(share->shares_[0]);
+    max_total += share->GetMaxFrames();
+  }
+  BufferPoolPartition *partition = new BufferPoolPartition(
+      name, min_frames, max_total, std::move(shares));
+  partitions_.push_back(partition);
+  return partition;
+}
+
+BufferPoolPartition *
+ParallelBufferPoolManager::GetPartition(const std::string &name) {
+  std::lock_guard<std::mutex> lck(latch_);
+  for (auto partition : partitions_) {
+    if (partition->GetName() == name)
+      return partition;
+  }
+  return nullptr;
+}
+
+std::vector<BufferPoolPartition *> ParallelBufferPoolManager::GetPartitions() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return partitions_;
+}
+
+} // namespace scudb
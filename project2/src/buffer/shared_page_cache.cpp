@@ -0,0 +1,270 @@
+/**
+ * shared_page_cache.cpp
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "buffer/shared_page_cache.h"
+#include "common/exception.h"
+
+namespace scudb {
+
+SharedPageCache::SharedPageCache(const std::string &name, size_t num_pages,
+                                 size_t page_size, const std::string &db_file)
+    : name_(name), attached_(false), page_size_(page_size), num_slots_(0),
+      num_buckets_(0), segment_size_(0), segment_(nullptr), header_(nullptr),
+      buckets_(nullptr), slots_(nullptr), data_(nullptr), num_hits_(0),
+      num_misses_(0) {
+  struct stat db_stat;
+  if (stat(db_file.c_str(), &db_stat) != 0)
+    throw Exception(EXCEPTION_TYPE_INVALID, "cannot stat " + db_file);
+
+  int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd >= 0) {
+    // a new segment: size it, lay it out, and publish it with the magic
+    segment_size_ = GetSegmentSize(num_pages, page_size_);
+    if (num_pages == 0 || ftruncate(fd, segment_size_) != 0) {
+      close(fd);
+      shm_unlink(name_.c_str());
+      throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                      "cannot size shared cache " + name_);
+    }
+  } else if (errno == EEXIST) {
+    attached_ = true;
+    fd = shm_open(name_.c_str(), O_RDWR, 0600);
+    // the creator may not have sized it yet
+    struct stat shm_stat;
+    for (int i = 0; fd >= 0 && i < 1000; ++i) {
+      if (fstat(fd, &shm_stat) == 0 && shm_stat.st_size > 0) {
+        segment_size_ = shm_stat.st_size;
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  if (fd < 0 || segment_size_ < sizeof(Header)) {
+    if (fd >= 0)
+      close(fd);
+    throw Exception(EXCEPTION_TYPE_INVALID, "cannot open shared cache " + name_);
+  }
+  void *segment = mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED)
+    throw Exception(EXCEPTION_TYPE_INVALID, "cannot map shared cache " + name_);
+  segment_ = static_cast<char *>(segment);
+  header_ = reinterpret_cast<Header *>(segment_);
+
+  if (!attached_) {
+    // the new segment reads as zeros
+    header_->page_size = page_size_;
+    header_->num_slots = num_pages;
+    header_->num_buckets = num_pages;
+    header_->db_device = db_stat.st_dev;
+    header_->db_inode = db_stat.st_ino;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header_->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    MapLayout();
+    Clear();
+    header_->magic.store(SHARED_CACHE_MAGIC, std::memory_order_release);
+    return;
+  }
+
+  // wait for the creator to finish the layout
+  for (int i = 0; i < 1000; ++i) {
+    if (header_->magic.load(std::memory_order_acquire) == SHARED_CACHE_MAGIC)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (header_->magic.load(std::memory_order_acquire) != SHARED_CACHE_MAGIC ||
+      header_->page_size != page_size_ ||
+      GetSegmentSize(header_->num_slots, page_size_) > segment_size_) {
+    munmap(segment_, segment_size_);
+    segment_ = nullptr;
+    throw Exception(EXCEPTION_TYPE_MISMATCH_TYPE,
+                    "shared cache " + name_ + " does not fit the database");
+  }
+  MapLayout();
+  Lock();
+  // the database file was replaced since the pages were cached
+  if (header_->db_device != static_cast<uint64_t>(db_stat.st_dev) ||
+      header_->db_inode != static_cast<uint64_t>(db_stat.st_ino)) {
+    header_->db_device = db_stat.st_dev;
+    header_->db_inode = db_stat.st_ino;
+    Clear();
+  }
+  Unlock();
+}
+
+SharedPageCache::~SharedPageCache() {
+  if (segment_ != nullptr)
+    munmap(segment_, segment_size_);
+}
+
+/*
+ * header, bucket heads and slots, then the page copies starting on a page
+ * boundary
+ */
+size_t SharedPageCache::GetSegmentSize(size_t num_slots, size_t page_size) {
+  size_t meta_size =
+      sizeof(Header) + num_slots * (sizeof(int32_t) + sizeof(Slot));
+  size_t data_offset = (meta_size + page_size - 1) / page_size * page_size;
+  return data_offset + num_slots * page_size;
+}
+
+void SharedPageCache::MapLayout() {
+  num_slots_ = header_->num_slots;
+  num_buckets_ = header_->num_buckets;
+  buckets_ = reinterpret_cast<int32_t *>(segment_ + sizeof(Header));
+  slots_ = reinterpret_cast<Slot *>(buckets_ + num_buckets_);
+  data_ = segment_ + GetSegmentSize(num_slots_, page_size_) -
+          num_slots_ * page_size_;
+}
+
+void SharedPageCache::Lock() {
+  if (pthread_mutex_lock(&header_->mutex) == EOWNERDEAD) {
+    // the owner died in the middle of an update
+    Clear();
+    pthread_mutex_consistent(&header_->mutex);
+  }
+}
+
+void SharedPageCache::Unlock() { pthread_mutex_unlock(&header_->mutex); }
+
+void SharedPageCache::Clear() {
+  for (size_t i = 0; i < num_buckets_; ++i)
+    buckets_[i] = -1;
+  for (size_t i = 0; i < num_slots_; ++i) {
+    slots_[i].page_id = INVALID_PAGE_ID;
+    slots_[i].next = -1;
+    slots_[i].referenced = 0;
+  }
+  header_->clock_hand = 0;
+  header_->num_pages = 0;
+}
+
+int32_t SharedPageCache::FindSlot(page_id_t page_id) {
+  int32_t slot = buckets_[GetBucket(page_id)];
+  while (slot >= 0 && slots_[slot].page_id != page_id)
+    slot = slots_[slot].next;
+  return slot;
+}
+
+void SharedPageCache::RemoveSlot(int32_t slot) {
+  int32_t *link = &buckets_[GetBucket(slots_[slot].page_id)];
+  while (*link != slot)
+    link = &slots_[*link].next;
+  *link = slots_[slot].next;
+  slots_[slot].page_id = INVALID_PAGE_ID;
+  slots_[slot].next = -1;
+  slots_[slot].referenced = 0;
+  header_->num_pages--;
+}
+
+/*
+ * Sweep the clock: a free slot is taken at once, a referenced one gets a
+ * second chance. Two rounds find a slot, even if all were referenced
+ */
+int32_t SharedPageCache::GetVictimSlot() {
+  while (true) {
+    int32_t slot = header_->clock_hand;
+    header_->clock_hand = (header_->clock_hand + 1) % num_slots_;
+    if (slots_[slot].page_id == INVALID_PAGE_ID)
+      return slot;
+    if (slots_[slot].referenced) {
+      slots_[slot].referenced = 0;
+      continue;
+    }
+    RemoveSlot(slot);
+    return slot;
+  }
+}
+
+void SharedPageCache::Put(page_id_t page_id, const char *page_data) {
+  Lock();
+  int32_t slot = FindSlot(page_id);
+  if (slot < 0) {
+    slot = GetVictimSlot();
+    slots_[slot].page_id = page_id;
+    slots_[slot].next = buckets_[GetBucket(page_id)];
+    buckets_[GetBucket(page_id)] = slot;
+    header_->num_pages++;
+  }
+  slots_[slot].referenced = 1;
+  memcpy(GetSlotData(slot), page_data, page_size_);
+  Unlock();
+}
+
+bool SharedPageCache::Get(page_id_t page_id, char *page_data) {
+  Lock();
+  int32_t slot = FindSlot(page_id);
+  if (slot >= 0) {
+    slots_[slot].referenced = 1;
+    memcpy(page_data, GetSlotData(slot), page_size_);
+  }
+  Unlock();
+  if (slot < 0) {
+    num_misses_++;
+    return false;
+  }
+  num_hits_++;
+  return true;
+}
+
+void SharedPageCache::Erase(page_id_t page_id) {
+  Lock();
+  int32_t slot = FindSlot(page_id);
+  if (slot >= 0)
+    RemoveSlot(slot);
+  Unlock();
+}
+
+size_t SharedPageCache::GetNumPages() {
+  Lock();
+  size_t num_pages = header_->num_pages;
+  Unlock();
+  return num_pages;
+}
+
+/*
+ * "/scudb.<file name>.<hash of the absolute path>": shm names are a single
+ * path component of limited length
+ */
+std::string SharedPageCache::GetSegmentName(const std::string &db_file) {
+  char path[PATH_MAX];
+  std::string full_path =
+      realpath(db_file.c_str(), path) != nullptr ? path : db_file;
+  // FNV-1a, stable across processes
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : full_path) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::string file_name = full_path.substr(full_path.find_last_of('/') + 1);
+  if (file_name.size() > 64)
+    file_name.resize(64);
+  char suffix[24];
+  snprintf(suffix, sizeof(suffix), ".%016llx",
+           static_cast<unsigned long long>(hash));
+  return "/scudb." + file_name + suffix;
+}
+
+void SharedPageCache::Remove(const std::string &name) {
+  shm_unlink(name.c_str());
+}
+
+} // namespace scudb
@@ -4,4 +4,6 @@ namespace scudb {
   std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
   std::chrono::duration<long long int> LOG_TIMEOUT =
    std::chrono::seconds(1);
+  std::chrono::milliseconds BG_WRITER_DELAY = std::chrono::milliseconds(100);
+  std::chrono::milliseconds WARM_IMAGE_DELAY = std::chrono::seconds(30);
 }
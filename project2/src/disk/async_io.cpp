@@ -0,0 +1,27 @@
+/**
+ * async_io.cpp
+ */
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "disk/async_io.h"
+#include "disk/io_uring_io.h"
+#include "disk/thread_pool_io.h"
+
+namespace scudb {
+
+std::unique_ptr<AsyncIO> AsyncIO::Create(size_t queue_depth) {
+#if DISK_IO_URING
+  try {
+    return std::unique_ptr<AsyncIO>(new IOUringIO(queue_depth));
+  } catch (Exception &) {
+    // e.g. an old kernel, or io_uring disabled by the administrator
+  }
+#endif
+  return std::unique_ptr<AsyncIO>(new ThreadPoolIO(
+      queue_depth, std::min<size_t>(queue_depth, DISK_IO_THREADS)));
+}
+
+} // namespace scudb
@@ -1,12 +1,17 @@
 /**
  * disk_manager.cpp
  */
+#include <algorithm>
 #include <assert.h>
+#include <cerrno>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <sys/stat.h>
 #include <thread>
+#include <unistd.h>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "disk/disk_manager.h"
 
@@ -14,13 +19,54 @@ namespace scudb {
 
 static char *buffer_used = nullptr;
 
+/*
+ * pread/pwrite may transfer less than asked for (or be interrupted), loop
+ * until all of it is done. Returns the bytes transferred, fewer at the end of
+ * the file, -1 on an error
+ */
+static ssize_t ReadFully(int fd, char *data, size_t size, off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pread(fd, data + done, size - done, offset + done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return -1;
+    if (n == 0)
+      break;
+    done += n;
+  }
+  return done;
+}
+
+static ssize_t WriteFully(int fd, const char *data, size_t size,
+                          off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pwrite(fd, data + done, size - done, offset + done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return -1;
+    done += n;
+  }
+  return done;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size: page size of a new database, a power of two between
+ * MIN_PAGE_SIZE and MAX_PAGE_SIZE
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
-      flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, size_t page_size)
+    : db_fd_(-1), file_name_(db_file), page_size_(page_size), next_page_id_(0),
+      space_maps_enabled_(true), older_format_(false), num_flushes_(0),
+      flush_log_(false), flush_log_f_(nullptr) {
+  if (page_size_ < MIN_PAGE_SIZE || page_size_ > MAX_PAGE_SIZE ||
+      (page_size_ & (page_size_ - 1)) != 0) {
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE, "unsupported page size");
+  }
   std::string::size_type n = file_name_.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -42,21 +88,41 @@ DiskManager::DiskManager(const std::string &db_file)
                                 std::ios::out);
   }
 
-  db_io_.open(db_file,
-              std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // create the file if it does not exist
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    LOG_DEBUG("cannot open db file");
+    return;
+  }
+
+  // an existing database: the header page starts with the format magic, the
+  // page size the database was created with and the format flags. Only a
+  // file created with space maps has them, in any other one the page where a
+  // map would go may be a data page
+  uint32_t format[3];
+  ssize_t format_size =
+      ReadFully(db_fd_, reinterpret_cast<char *>(format), sizeof(format), 0);
+  if (format_size == sizeof(format) && format[0] == DB_FORMAT_MAGIC) {
+    page_size_ = format[1];
+    space_maps_enabled_ = (format[2] & DB_FORMAT_SPACE_MAPS) != 0;
+  } else if (format_size > 0) {
+    space_maps_enabled_ = false;
+    // a header page never written reads as zeros, anything else is the
+    // header of an older version (record count first, 512 byte pages)
+    const char *bytes = reinterpret_cast<const char *>(format);
+    older_format_ = std::any_of(bytes, bytes + format_size,
+                                [](char byte) { return byte != 0; });
   }
+  LoadSpaceMaps();
 }
 
 DiskManager::~DiskManager() {
-  db_io_.close();
+  // the engine finishes the requests in flight
+  async_io_.reset();
+  if (db_fd_ >= 0) {
+    Sync();
+    close(db_fd_);
+  }
   log_io_.close();
 }
 
@@ -64,42 +130,117 @@ DiskManager::~DiskManager() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = page_id * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  off_t offset = static_cast<off_t>(page_id) * page_size_;
   // check for I/O error
-  if (db_io_.bad()) {
+  if (WriteFully(db_fd_, page_data, page_size_, offset) < 0) {
     LOG_DEBUG("I/O error while writing");
-    return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  off_t offset = static_cast<off_t>(page_id) * page_size_;
+  ssize_t read_count = ReadFully(db_fd_, page_data, page_size_, offset);
+  if (read_count < 0) {
     LOG_DEBUG("I/O error while reading");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    return;
+  }
+  // if file ends before reading a page
+  if (static_cast<size_t>(read_count) < page_size_) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, page_size_ - read_count);
   }
 }
 
+/**
+ * Read num_pages consecutive pages starting at page_id with a single read.
+ * Pages past the end of the file come back zeroed and are not counted.
+ */
+int DiskManager::ReadPages(page_id_t page_id, int num_pages, char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * page_size_;
+  size_t size = num_pages * page_size_;
+  ssize_t read_count = ReadFully(db_fd_, page_data, size, offset);
+  if (read_count < 0)
+    read_count = 0;
+  if (static_cast<size_t>(read_count) < size)
+    memset(page_data + read_count, 0, size - read_count);
+  return (read_count + page_size_ - 1) / page_size_;
+}
+
+/**
+ * Writes only hand the pages to the OS, durability is asked for explicitly,
+ * e.g. at a shutdown
+ */
+void DiskManager::Sync() {
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+AsyncIO *DiskManager::GetAsyncIO() {
+  std::call_once(async_io_flag_,
+                 [this] { async_io_ = AsyncIO::Create(DISK_IO_QUEUE_DEPTH); });
+  return async_io_.get();
+}
+
+/*
+ * The callbacks run on a thread of the I/O engine, they only fill the tail
+ * of short reads and hand the result over
+ */
+std::future<void> DiskManager::ReadPageAsync(page_id_t page_id,
+                                             char *page_data) {
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> future = done->get_future();
+  size_t page_size = page_size_;
+  GetAsyncIO()->Submit(IOOp::READ, db_fd_, page_data, page_size,
+                       static_cast<off_t>(page_id) * page_size,
+                       [=](ssize_t result) {
+                         if (result < 0) {
+                           LOG_DEBUG("I/O error while reading");
+                           result = 0;
+                         }
+                         if (static_cast<size_t>(result) < page_size)
+                           memset(page_data + result, 0, page_size - result);
+                         done->set_value();
+                       });
+  return future;
+}
+
+std::future<void> DiskManager::WritePageAsync(page_id_t page_id,
+                                              const char *page_data) {
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> future = done->get_future();
+  GetAsyncIO()->Submit(IOOp::WRITE, db_fd_, const_cast<char *>(page_data),
+                       page_size_, static_cast<off_t>(page_id) * page_size_,
+                       [=](ssize_t result) {
+                         if (result < 0) {
+                           LOG_DEBUG("I/O error while writing");
+                         }
+                         done->set_value();
+                       });
+  return future;
+}
+
+std::future<int> DiskManager::ReadPagesAsync(page_id_t page_id, int num_pages,
+                                             char *page_data) {
+  auto done = std::make_shared<std::promise<int>>();
+  std::future<int> future = done->get_future();
+  size_t page_size = page_size_;
+  size_t size = num_pages * page_size;
+  GetAsyncIO()->Submit(IOOp::READ, db_fd_, page_data, size,
+                       static_cast<off_t>(page_id) * page_size,
+                       [=](ssize_t result) {
+                         if (result < 0)
+                           result = 0;
+                         if (static_cast<size_t>(result) < size)
+                           memset(page_data + result, 0, size - result);
+                         done->set_value((result + page_size - 1) / page_size);
+                       });
+  return future;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -158,16 +299,195 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuse the lowest free page, keeping the file compact; otherwise take the
+ * next page, stepping over the space map pages
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() {
+  std::lock_guard<std::mutex> lck(allocation_latch_);
+  page_id_t page_id;
+  if (!free_pages_.empty()) {
+    page_id = *free_pages_.begin();
+    free_pages_.erase(free_pages_.begin());
+  } else {
+    page_id = next_page_id_++;
+    if (space_maps_enabled_ && IsSpaceMapPage(page_id))
+      page_id = next_page_id_++;
+  }
+  // a group with a map records its pages in use too
+  UpdateSpaceMap(page_id, false);
+  return page_id;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * The header page and the space map pages are never free
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> lck(allocation_latch_);
+  if (!space_maps_enabled_ || page_id <= HEADER_PAGE_ID ||
+      page_id >= next_page_id_ || IsSpaceMapPage(page_id) ||
+      !free_pages_.insert(page_id).second)
+    return;
+  UpdateSpaceMap(page_id, true);
+}
+
+/*
+ * Extents come from the free pages too, but only from a run of num_pages of
+ * them: shorter runs are left to AllocatePage, they would split the pages of
+ * a table up again
+ */
+page_id_t DiskManager::AllocateExtent(int &num_pages) {
+  std::lock_guard<std::mutex> lck(allocation_latch_);
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  int run = 0;
+  for (page_id_t page_id : free_pages_) {
+    if (run > 0 && page_id == first_page_id + run) {
+      run++;
+    } else {
+      first_page_id = page_id;
+      run = 1;
+    }
+    if (run == num_pages)
+      break;
+  }
+  if (run == num_pages) {
+    free_pages_.erase(free_pages_.find(first_page_id),
+                      free_pages_.upper_bound(first_page_id + run - 1));
+    bool has_map = false;
+    for (page_id_t page_id = first_page_id; page_id < first_page_id + run;
+         ++page_id)
+      has_map = MarkSpaceMap(page_id, false) || has_map;
+    if (has_map)
+      WriteSpaceMap(first_page_id);
+    return first_page_id;
+  }
+
+  if (space_maps_enabled_ && IsSpaceMapPage(next_page_id_))
+    next_page_id_++;
+  first_page_id = next_page_id_;
+  if (space_maps_enabled_) {
+    page_id_t map_page_id = first_page_id / SPACE_MAP_GROUP_PAGES *
+                                SPACE_MAP_GROUP_PAGES +
+                            SPACE_MAP_GROUP_PAGES - 1;
+    num_pages = std::min<page_id_t>(num_pages, map_page_id - first_page_id);
+  }
+  next_page_id_ += num_pages;
+  // a map at the end of the file has to record the reserved pages as used
+  UpdateSpaceMap(first_page_id, false);
+  return first_page_id;
+}
+
+/*
+ * A run at the end of the used pages is simply not used then, one in between
+ * becomes free pages. A run never spans two groups
+ */
+void DiskManager::DeallocateExtent(page_id_t first_page_id, int num_pages) {
+  std::lock_guard<std::mutex> lck(allocation_latch_);
+  if (num_pages <= 0)
+    return;
+  if (first_page_id + num_pages == next_page_id_) {
+    next_page_id_ = first_page_id;
+    UpdateSpaceMap(first_page_id, false);
+    return;
+  }
+  if (!space_maps_enabled_)
+    return;
+  for (page_id_t page_id = first_page_id; page_id < first_page_id + num_pages;
+       ++page_id) {
+    free_pages_.insert(page_id);
+    MarkSpaceMap(page_id, true);
+  }
+  WriteSpaceMap(first_page_id);
+}
+
+size_t DiskManager::GetNumFreePages() {
+  std::lock_guard<std::mutex> lck(allocation_latch_);
+  return free_pages_.size();
+}
+
+page_id_t DiskManager::GetNextPageId() {
+  std::lock_guard<std::mutex> lck(allocation_latch_);
+  return next_page_id_;
+}
+
+/*
+ * Space map page: magic, next_page_id_ when it was written, then one bit per
+ * page of the group, set for a free page. Every map carries next_page_id_,
+ * the one at the end of the file tells where allocation stopped
+ */
+void DiskManager::UpdateSpaceMap(page_id_t page_id, bool is_free) {
+  if (MarkSpaceMap(page_id, is_free))
+    WriteSpaceMap(page_id);
+}
+
+bool DiskManager::MarkSpaceMap(page_id_t page_id, bool is_free) {
+  if (!space_maps_enabled_)
+    return false;
+  size_t group = page_id / SPACE_MAP_GROUP_PAGES;
+  if (group >= space_maps_.size())
+    space_maps_.resize(group + 1);
+  std::unique_ptr<char[]> &map = space_maps_[group];
+  if (map == nullptr) {
+    if (!is_free)
+      return false;
+    map.reset(new char[page_size_]());
+    uint32_t magic = SPACE_MAP_MAGIC;
+    memcpy(map.get(), &magic, sizeof(magic));
+  }
+  uint8_t *bits = reinterpret_cast<uint8_t *>(map.get() + 8);
+  size_t bit = page_id % SPACE_MAP_GROUP_PAGES;
+  if (is_free)
+    bits[bit / 8] |= 1 << (bit % 8);
+  else
+    bits[bit / 8] &= ~(1 << (bit % 8));
+  return true;
+}
+
+void DiskManager::WriteSpaceMap(page_id_t page_id) {
+  size_t group = page_id / SPACE_MAP_GROUP_PAGES;
+  std::unique_ptr<char[]> &map = space_maps_[group];
+  memcpy(map.get() + 4, &next_page_id_, sizeof(page_id_t));
+  WritePage(group * SPACE_MAP_GROUP_PAGES + SPACE_MAP_GROUP_PAGES - 1,
+            map.get());
+}
+
+/*
+ * The pages in use end with the file, unless its last page is a space map
+ * page: that one was written past the pages in use and records where they
+ * end. One read per group, none for a file without space maps
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  return;
+void DiskManager::LoadSpaceMaps() {
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0)
+    return;
+  page_id_t num_pages = (stat_buf.st_size + page_size_ - 1) / page_size_;
+  next_page_id_ = num_pages;
+  if (!space_maps_enabled_)
+    return;
+  std::unique_ptr<char[]> map(new char[page_size_]);
+  for (page_id_t map_page_id = SPACE_MAP_GROUP_PAGES - 1;
+       map_page_id < num_pages; map_page_id += SPACE_MAP_GROUP_PAGES) {
+    ReadPage(map_page_id, map.get());
+    uint32_t magic;
+    memcpy(&magic, map.get(), sizeof(magic));
+    // a group without a free page has no map yet
+    if (magic != SPACE_MAP_MAGIC)
+      continue;
+    if (map_page_id == num_pages - 1)
+      memcpy(&next_page_id_, map.get() + 4, sizeof(page_id_t));
+    size_t group = map_page_id / SPACE_MAP_GROUP_PAGES;
+    const uint8_t *bits = reinterpret_cast<const uint8_t *>(map.get() + 8);
+    for (size_t bit = 0; bit < SPACE_MAP_GROUP_PAGES - 1; ++bit) {
+      if (bits[bit / 8] & (1 << (bit % 8)))
+        free_pages_.insert(group * SPACE_MAP_GROUP_PAGES + bit);
+    }
+    if (group >= space_maps_.size())
+      space_maps_.resize(group + 1);
+    space_maps_[group] = std::move(map);
+    map.reset(new char[page_size_]);
+  }
+  // pages freed past the end of the used ones are simply not used yet
+  free_pages_.erase(free_pages_.lower_bound(next_page_id_), free_pages_.end());
 }
 
 /**
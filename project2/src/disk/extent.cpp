@@ -0,0 +1,52 @@
+/**
+ * extent.cpp
+ */
+
+#include "disk/disk_manager.h"
+#include "disk/extent.h"
+
+namespace scudb {
+
+Extent::Extent(int num_pages)
+    : num_pages_(num_pages), disk_manager_(nullptr),
+      next_page_id_(INVALID_PAGE_ID), end_page_id_(INVALID_PAGE_ID) {}
+
+page_id_t Extent::AllocatePage(DiskManager *disk_manager) {
+  std::lock_guard<std::mutex> lck(latch_);
+  if (next_page_id_ == end_page_id_) {
+    int num_pages = num_pages_;
+    disk_manager_ = disk_manager;
+    next_page_id_ = disk_manager_->AllocateExtent(num_pages);
+    end_page_id_ = next_page_id_ + num_pages;
+  }
+  return next_page_id_++;
+}
+
+/*
+ * The page goes back to the run if it was the last one taken from it, e.g.
+ * when no frame was free to hold it
+ */
+void Extent::DeallocatePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> lck(latch_);
+  if (disk_manager_ == nullptr)
+    return;
+  if (page_id == next_page_id_ - 1)
+    next_page_id_--;
+  else
+    disk_manager_->DeallocatePage(page_id);
+}
+
+void Extent::Release() {
+  std::lock_guard<std::mutex> lck(latch_);
+  if (disk_manager_ == nullptr)
+    return;
+  disk_manager_->DeallocateExtent(next_page_id_, end_page_id_ - next_page_id_);
+  next_page_id_ = end_page_id_;
+}
+
+int Extent::GetNumFreePages() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return end_page_id_ - next_page_id_;
+}
+
+} // namespace scudb
@@ -0,0 +1,179 @@
+/**
+ * io_uring_io.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/exception.h"
+#include "disk/io_uring_io.h"
+
+namespace scudb {
+
+static int IOUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                        unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+/*
+ * Map the submission ring, the completion ring (the same mapping on kernels
+ * with IORING_FEAT_SINGLE_MMAP) and the submission entries, then start the
+ * completion thread
+ */
+IOUringIO::IOUringIO(size_t queue_depth)
+    : queue_depth_(queue_depth), ring_fd_(-1), sq_ring_(MAP_FAILED),
+      sq_ring_size_(0), cq_ring_(MAP_FAILED), cq_ring_size_(0),
+      sqes_(static_cast<io_uring_sqe *>(MAP_FAILED)), sqes_size_(0),
+      num_in_flight_(0), reaper_(nullptr) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = syscall(__NR_io_uring_setup, queue_depth_, &params);
+  if (ring_fd_ < 0)
+    throw Exception(EXCEPTION_TYPE_NOT_IMPLEMENTED, "io_uring not available");
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    cq_ring_size_ = sq_ring_size_;
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ != MAP_FAILED)
+    cq_ring_ = single_mmap ? sq_ring_
+                           : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                  IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  if (cq_ring_ != MAP_FAILED)
+    sqes_ = static_cast<io_uring_sqe *>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+  if (sqes_ == MAP_FAILED) {
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+      munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != MAP_FAILED)
+      munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+    throw Exception(EXCEPTION_TYPE_NOT_IMPLEMENTED, "cannot map io_uring");
+  }
+
+  char *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+  char *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  // never more in flight than the rings hold
+  if (queue_depth_ > params.sq_entries)
+    queue_depth_ = params.sq_entries;
+
+  reaper_ = new std::thread([this] { ReapLoop(); });
+}
+
+/*
+ * Wait for the requests in flight, then stop the completion thread with a
+ * no-op request
+ */
+IOUringIO::~IOUringIO() {
+  {
+    std::unique_lock<std::mutex> lck(submit_latch_);
+    slot_cv_.wait(lck, [this] { return num_in_flight_ == 0; });
+    Enqueue(nullptr);
+  }
+  reaper_->join();
+  delete reaper_;
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_)
+    munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+void IOUringIO::Submit(IOOp op, int fd, char *data, size_t size, off_t offset,
+                       IOCallback callback) {
+  Request *request =
+      new Request{op, fd, data, size, offset, 0, std::move(callback)};
+  std::unique_lock<std::mutex> lck(submit_latch_);
+  slot_cv_.wait(lck, [this] { return num_in_flight_ < queue_depth_; });
+  num_in_flight_++;
+  Enqueue(request);
+}
+
+/*
+ * Caller holds submit_latch_. The kernel consumes the entry while entering,
+ * so there is always room for the requests in flight
+ */
+void IOUringIO::Enqueue(Request *request) {
+  uint32_t tail = *sq_tail_;
+  uint32_t index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  if (request == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    sqe->opcode =
+        request->op == IOOp::READ ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe->fd = request->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(request->data + request->done);
+    sqe->len = request->size - request->done;
+    sqe->off = request->offset + request->done;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  // the entry has to be visible to the kernel before the new tail
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  while (IOUringEnter(ring_fd_, 1, 0, 0) < 0 &&
+         (errno == EINTR || errno == EAGAIN || errno == EBUSY)) {
+  }
+}
+
+/*
+ * Wait for completions. An interrupted request is submitted again, a short
+ * one continues with its rest; a read stops at the end of the file
+ */
+void IOUringIO::ReapLoop() {
+  while (true) {
+    uint32_t head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      IOUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      continue;
+    }
+    io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+    Request *request = reinterpret_cast<Request *>(cqe->user_data);
+    int result = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (request == nullptr)
+      return;
+
+    if (result == -EINTR || result == -EAGAIN) {
+      std::lock_guard<std::mutex> lck(submit_latch_);
+      Enqueue(request);
+      continue;
+    }
+    if (result > 0) {
+      request->done += result;
+      if (request->done < request->size) {
+        std::lock_guard<std::mutex> lck(submit_latch_);
+        Enqueue(request);
+        continue;
+      }
+    }
+    request->callback(result < 0 ? result : request->done);
+    delete request;
+    std::lock_guard<std::mutex> lck(submit_latch_);
+    num_in_flight_--;
+    slot_cv_.notify_all();
+  }
+}
+
+} // namespace scudb
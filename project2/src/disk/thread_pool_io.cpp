@@ -0,0 +1,76 @@
+/**
+ * thread_pool_io.cpp
+ */
+
+#include <cerrno>
+#include <unistd.h>
+
+#include "disk/thread_pool_io.h"
+
+namespace scudb {
+
+ThreadPoolIO::ThreadPoolIO(size_t queue_depth, size_t num_threads)
+    : queue_depth_(queue_depth), num_in_flight_(0), running_(true) {
+  for (size_t i = 0; i < num_threads; ++i)
+    workers_.push_back(std::thread([this] { WorkerLoop(); }));
+}
+
+/*
+ * The workers finish the queued requests before they stop
+ */
+ThreadPoolIO::~ThreadPoolIO() {
+  {
+    std::lock_guard<std::mutex> lck(latch_);
+    running_ = false;
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_)
+    worker.join();
+}
+
+void ThreadPoolIO::Submit(IOOp op, int fd, char *data, size_t size,
+                          off_t offset, IOCallback callback) {
+  {
+    std::unique_lock<std::mutex> lck(latch_);
+    slot_cv_.wait(lck, [this] { return num_in_flight_ < queue_depth_; });
+    num_in_flight_++;
+    queue_.push_back(Request{op, fd, data, size, offset, std::move(callback)});
+  }
+  work_cv_.notify_one();
+}
+
+void ThreadPoolIO::WorkerLoop() {
+  std::unique_lock<std::mutex> lck(latch_);
+  while (true) {
+    work_cv_.wait(lck, [this] { return !running_ || !queue_.empty(); });
+    if (queue_.empty())
+      return;
+    Request request = std::move(queue_.front());
+    queue_.pop_front();
+    lck.unlock();
+
+    // a short transfer continues with its rest, a read stops at the end of
+    // the file
+    size_t done = 0;
+    ssize_t result = 0;
+    while (done < request.size) {
+      result = request.op == IOOp::READ
+                   ? pread(request.fd, request.data + done, request.size - done,
+                           request.offset + done)
+                   : pwrite(request.fd, request.data + done,
+                            request.size - done, request.offset + done);
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        break;
+      done += result;
+    }
+    request.callback(result < 0 ? -errno : done);
+
+    lck.lock();
+    num_in_flight_--;
+    slot_cv_.notify_one();
+  }
+}
+
+} // namespace scudb
@@ -0,0 +1,229 @@
+#include <cassert>
+#include <thread>
+
+#include "hash/page_table.h"
+#include "page/page.h"
+
+namespace scudb {
+
+/*
+ * constructor
+ * capacity is the smallest power of two holding max_size at load factor 1/2
+ */
+template <typename V>
+PageTable<V>::PageTable(size_t max_size)
+    : max_size_(max_size), size_(0) {
+  size_t capacity = 16;
+  size_t bits = 4;
+  while (capacity < 2 * max_size_) {
+    capacity <<= 1;
+    bits++;
+  }
+  shift_ = 64 - bits;
+  mask_ = capacity - 1;
+  keys_.reset(new std::atomic<page_id_t>[capacity]);
+  values_.reset(new std::atomic<V>[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    keys_[i].store(INVALID_PAGE_ID, std::memory_order_relaxed);
+    values_[i].store(V(), std::memory_order_relaxed);
+  }
+  versions_.reset(new Version[capacity / VERSION_GROUP_SLOTS]);
+  for (size_t i = 0; i < capacity / VERSION_GROUP_SLOTS; ++i)
+    versions_[i].value.store(0, std::memory_order_relaxed);
+}
+
+template <typename V> size_t PageTable<V>::HashKey(page_id_t key) const {
+  uint64_t hash = static_cast<uint32_t>(key) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(hash >> shift_) & mask_;
+}
+
+/*
+ * lookup function to find value associated with input key
+ * Probe without any lock, reading the counter of every group of slots before
+ * its slots, then check none of those groups changed meanwhile. A probe that
+ * overlapped a writer of its slots is retried, so a concurrent Insert/Remove
+ * never produces a wrong answer. Every slot read was unchanged from its read
+ * to the check, so the answer holds at the end of the probe.
+ */
+template <typename V> bool PageTable<V>::Find(const page_id_t &key, V &value) {
+  assert(key != INVALID_PAGE_ID);
+  size_t num_groups = (mask_ + 1) / VERSION_GROUP_SLOTS;
+  size_t versions[MAX_PROBE_GROUPS];
+  while (true) {
+    bool found = false;
+    bool retry = false;
+    V result = V();
+    size_t slot = HashKey(key);
+    size_t first_group = slot / VERSION_GROUP_SLOTS;
+    size_t num_probed = 0;
+    for (size_t probes = 0; probes <= mask_; ++probes) {
+      if (probes == 0 || slot % VERSION_GROUP_SLOTS == 0) {
+        if (num_probed == MAX_PROBE_GROUPS)
+          return FindLocked(key, value);
+        size_t version = versions_[slot / VERSION_GROUP_SLOTS].value.load(
+            std::memory_order_acquire);
+        if (version & 1) {
+          retry = true;
+          break;
+        }
+        versions[num_probed++] = version;
+      }
+      page_id_t slot_key = keys_[slot].load(std::memory_order_relaxed);
+      if (slot_key == INVALID_PAGE_ID)
+        break;
+      if (slot_key == key) {
+        result = values_[slot].load(std::memory_order_relaxed);
+        found = true;
+        break;
+      }
+      slot = (slot + 1) & mask_;
+    }
+    if (retry) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    for (size_t i = 0; i < num_probed && !retry; ++i) {
+      retry = versions_[(first_group + i) % num_groups].value.load(
+                  std::memory_order_relaxed) != versions[i];
+    }
+    if (!retry) {
+      if (found)
+        value = result;
+      return found;
+    }
+  }
+}
+
+template <typename V>
+bool PageTable<V>::FindLocked(const page_id_t &key, V &value) {
+  std::lock_guard<std::mutex> lck(latch_);
+  size_t slot = HashKey(key);
+  while (true) {
+    page_id_t slot_key = keys_[slot].load(std::memory_order_relaxed);
+    if (slot_key == INVALID_PAGE_ID)
+      return false;
+    if (slot_key == key) {
+      value = values_[slot].load(std::memory_order_relaxed);
+      return true;
+    }
+    slot = (slot + 1) & mask_;
+  }
+}
+
+/*
+ * delete <key,value> entry in hash table
+ * The hole is filled by shifting later entries of the probe chain back, so
+ * there are no tombstones and lookups stay short.
+ * Shall not shrink & combine buckets for simplicity
+ */
+template <typename V> bool PageTable<V>::Remove(const page_id_t &key) {
+  std::lock_guard<std::mutex> lck(latch_);
+  size_t hole = HashKey(key);
+  while (true) {
+    page_id_t slot_key = keys_[hole].load(std::memory_order_relaxed);
+    if (slot_key == INVALID_PAGE_ID)
+      return false;
+    if (slot_key == key)
+      break;
+    hole = (hole + 1) & mask_;
+  }
+
+  // the entries shifted back all lie before the next empty slot
+  size_t last_slot = hole;
+  while (keys_[(last_slot + 1) & mask_].load(std::memory_order_relaxed) !=
+         INVALID_PAGE_ID)
+    last_slot = (last_slot + 1) & mask_;
+  size_t first_slot = hole;
+  BeginWrite(first_slot, last_slot);
+  size_t slot = hole;
+  while (true) {
+    slot = (slot + 1) & mask_;
+    page_id_t slot_key = keys_[slot].load(std::memory_order_relaxed);
+    if (slot_key == INVALID_PAGE_ID)
+      break;
+    // entries whose home lies cyclically in (hole, slot] must stay put
+    size_t home = HashKey(slot_key);
+    if ((slot > hole && home > hole && home <= slot) ||
+        (slot < hole && (home > hole || home <= slot)))
+      continue;
+    keys_[hole].store(slot_key, std::memory_order_relaxed);
+    values_[hole].store(values_[slot].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    hole = slot;
+  }
+  keys_[hole].store(INVALID_PAGE_ID, std::memory_order_relaxed);
+  size_--;
+  EndWrite(first_slot, last_slot);
+  return true;
+}
+
+/*
+ * insert <key,value> entry in hash table
+ * If the key is present its value is replaced
+ */
+template <typename V>
+void PageTable<V>::Insert(const page_id_t &key, const V &value) {
+  assert(key != INVALID_PAGE_ID);
+  std::lock_guard<std::mutex> lck(latch_);
+  size_t slot = HashKey(key);
+  while (true) {
+    page_id_t slot_key = keys_[slot].load(std::memory_order_relaxed);
+    if (slot_key == INVALID_PAGE_ID || slot_key == key)
+      break;
+    slot = (slot + 1) & mask_;
+  }
+
+  BeginWrite(slot, slot);
+  if (keys_[slot].load(std::memory_order_relaxed) == INVALID_PAGE_ID) {
+    assert(size_ < max_size_);
+    size_++;
+  }
+  values_[slot].store(value, std::memory_order_relaxed);
+  keys_[slot].store(key, std::memory_order_relaxed);
+  EndWrite(slot, slot);
+}
+
+template <typename V> size_t PageTable<V>::Size() {
+  std::lock_guard<std::mutex> lck(latch_);
+  return size_;
+}
+
+/*
+ * Every group of the slots is odd before the first slot changes, so a
+ * reader never sees part of a change in one group and the rest in another
+ */
+template <typename V>
+void PageTable<V>::BeginWrite(size_t first_slot, size_t last_slot) {
+  size_t num_groups = (mask_ + 1) / VERSION_GROUP_SLOTS;
+  size_t group = first_slot / VERSION_GROUP_SLOTS;
+  while (true) {
+    auto &version = versions_[group].value;
+    version.store(version.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+    if (group == last_slot / VERSION_GROUP_SLOTS)
+      break;
+    group = (group + 1) % num_groups;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename V>
+void PageTable<V>::EndWrite(size_t first_slot, size_t last_slot) {
+  size_t num_groups = (mask_ + 1) / VERSION_GROUP_SLOTS;
+  size_t group = first_slot / VERSION_GROUP_SLOTS;
+  while (true) {
+    auto &version = versions_[group].value;
+    version.store(version.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_release);
+    if (group == last_slot / VERSION_GROUP_SLOTS)
+      break;
+    group = (group + 1) % num_groups;
+  }
+}
+
+template class PageTable<Page *>;
+// test purpose
+template class PageTable<int>;
+
+} // namespace scudb
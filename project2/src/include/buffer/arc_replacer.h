@@ -0,0 +1,69 @@
+/**
+ * arc_replacer.h
+ *
+ * Functionality: Adaptive Replacement Cache. Resident frames live in T1
+ * (seen once) or T2 (seen at least twice); pages evicted from them are
+ * remembered by page id in the ghost lists B1 and B2. A miss that hits B1
+ * means T1 was too small, a miss that hits B2 means T2 was too small, and the
+ * target size of T1 moves accordingly. Victims come from T1 while it is above
+ * its target, from T2 otherwise, so the split between recency and frequency
+ * follows the workload.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace scudb {
+
+template <typename T> class ARCReplacer : public Replacer<T> {
+public:
+  // num_frames: number of frame slots, every value must map below it
+  explicit ARCReplacer(size_t num_frames);
+
+  ~ARCReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void Reset(const T &value);
+
+  // current target number of frames for T1 (recency) and T2 (frequency)
+  size_t GetTargetRecencySize();
+  size_t GetTargetFrequencySize();
+
+private:
+  enum ListType { NONE = 0, T1, T2 };
+
+  // evict the least recent evictable frame of list, false if there is none
+  bool EvictFrom(ListType list, T &value);
+  // remove the least recent ghosts until both ghost bounds hold again
+  void TrimGhosts();
+
+  size_t num_frames_;
+  size_t target_t1_; // p in the ARC paper
+  size_t size_;      // number of evictable frames
+  std::list<size_t> t1_, t2_;          // frame ids, most recent first
+  std::list<page_id_t> b1_, b2_;       // ghost page ids, most recent first
+  std::vector<T> values_;              // value held by each frame
+  std::vector<page_id_t> page_ids_;    // page held by each frame
+  std::vector<ListType> lists_;        // resident list of each frame
+  std::vector<std::list<size_t>::iterator> positions_;
+  std::vector<bool> in_use_;           // frame can be evicted
+  std::unordered_map<page_id_t,
+                     std::pair<ListType, std::list<page_id_t>::iterator>>
+      ghosts_;
+  std::mutex latch_;
+};
+
+} // namespace scudb
@@ -0,0 +1,91 @@
+/*
+ * buffer_pool.h
+ *
+ * Functionality: The page interface of a buffer pool, what tables and indexes
+ * work with. It is implemented by a single BufferPoolManager, by a
+ * ParallelBufferPoolManager sharding pages among several of them, and by a
+ * named BufferPoolPartition of either. How the pool is run (its size, the
+ * background threads, the warm-up image, the cache tiers) is up to the
+ * class that owns the frames.
+ */
+
+#pragma once
+#include <cstdint>
+#include <functional>
+
+#include "buffer/buffer_ring.h"
+#include "disk/extent.h"
+#include "page/page.h"
+
+namespace scudb {
+// reads the id of the page that follows a (read latched) page in a chain
+typedef std::function<page_id_t(Page *)> NextPageFunc;
+// how long a page should stay in the pool, e.g. by B+ tree level: frames of a
+// lower priority are evicted first. A page starts out LOW, UNCHANGED leaves
+// its priority as it is
+enum class PagePriority : uint8_t { LOW = 0, INTERNAL, ROOT, UNCHANGED };
+// number of priorities a page can have
+static constexpr size_t NUM_PAGE_PRIORITIES =
+    static_cast<size_t>(PagePriority::UNCHANGED);
+
+class BufferPool {
+  // its read-ahead thread pins the pages of a request through the pool the
+  // request was made to
+  friend class BufferPoolManager;
+
+public:
+  virtual ~BufferPool() {}
+
+  // priority is a hint for the page while it is in the pool
+  virtual Page *FetchPage(page_id_t page_id,
+                          PagePriority priority = PagePriority::UNCHANGED) = 0;
+
+  // FetchPage for a large scan, a miss recycles a frame of the scan's ring
+  virtual Page *FetchPage(page_id_t page_id, BufferRing *ring) = 0;
+
+  // a resident page for an optimistic read, with its version; not pinned,
+  // an odd version means the read has to be retried
+  virtual Page *FetchPageOptimistic(page_id_t page_id, uint64_t &version) = 0;
+
+  // FetchPageOptimistic for the child in slot of an internal page, through
+  // the parent's swizzled reference while the child is resident
+  virtual Page *FetchChildOptimistic(Page *parent, int slot,
+                                     page_id_t child_page_id,
+                                     uint64_t &version) = 0;
+
+  // pin a frame an optimistic read found holding page_id
+  virtual Page *FetchFrame(Page *frame, page_id_t page_id) = 0;
+
+  // priority is a hint for the page while it is in the pool, the root of a
+  // B+ tree is kept over its internal pages, those over the leaves
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty,
+                         PagePriority priority = PagePriority::UNCHANGED) = 0;
+
+  virtual bool FlushPage(page_id_t page_id) = 0;
+
+  virtual Page *NewPage(page_id_t &page_id) = 0;
+
+  // NewPage for a table or index, the page is taken from its extent so that
+  // its pages are contiguous in the file; extent == nullptr is plain NewPage
+  virtual Page *NewPage(page_id_t &page_id, Extent *extent) = 0;
+
+  virtual bool DeletePage(page_id_t page_id) = 0;
+
+  // asynchronously read the pages following page_id along a page chain
+  virtual void ReadAhead(page_id_t page_id, NextPageFunc next_page) = 0;
+
+  // number of frames the pages can take
+  virtual size_t GetPoolSize() = 0;
+  // size of a page, fixed by the database file
+  virtual size_t GetPageSize() const = 0;
+
+  // FetchPage calls served from the pool / read from disk
+  virtual size_t GetNumHits() = 0;
+  virtual size_t GetNumMisses() = 0;
+
+private:
+  // read-ahead pin of a page and its release, which is not an access
+  virtual Page *PrefetchPage(page_id_t page_id) = 0;
+  virtual void ReleasePrefetched(Page *page) = 0;
+};
+} // namespace scudb
@@ -7,41 +7,338 @@
  */
 
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <list>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool.h"
+#include "buffer/buffer_ring.h"
+#include "buffer/buffered_replacer.h"
+#include "buffer/compressed_cache.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/shared_page_cache.h"
 #include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
+#include "disk/extent.h"
+#include "hash/page_table.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
 namespace scudb {
-class BufferPoolManager {
+// replacement policy used to pick victim frames
+enum class ReplacerType { LRU = 0, CLOCK, LRU_K, ARC };
+// a resident page of a warm-up image and its temperature (hits while resident)
+typedef std::pair<page_id_t, uint32_t> WarmPage;
+
+class BufferPoolPartition;
+
+class BufferPoolManager : public BufferPool {
+  friend class ParallelBufferPoolManager;
+  friend class BufferPoolPartition;
+
 public:
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
-                          LogManager *log_manager = nullptr);
+                          LogManager *log_manager = nullptr,
+                          ReplacerType replacer_type = ReplacerType::LRU,
+                          size_t max_pool_size = 0);
 
   ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  Page *FetchPage(page_id_t page_id,
+                  PagePriority priority = PagePriority::UNCHANGED) override;
+
+  Page *FetchPageOptimistic(page_id_t page_id, uint64_t &version) override;
+
+  Page *FetchChildOptimistic(Page *parent, int slot, page_id_t child_page_id,
+                             uint64_t &version) override;
+
+  Page *FetchFrame(Page *frame, page_id_t page_id) override;
+
+  Page *FetchPage(page_id_t page_id, BufferRing *ring) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty,
+                 PagePriority priority = PagePriority::UNCHANGED) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  Page *NewPage(page_id_t &page_id, Extent *extent) override;
+
+  bool DeletePage(page_id_t page_id) override;
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  // number of frames
+  size_t GetPoolSize() override;
+  // frames Resize() can grow the pool to
+  size_t GetMaxPoolSize();
+  // grow or shrink the pool while it is in use
+  void Resize(size_t new_size);
+  // bytes taken by the frames: content in use plus metadata
+  size_t GetMemoryUsage();
+  size_t GetPageSize() const override { return page_size_; }
 
-  bool FlushPage(page_id_t page_id);
+  size_t GetNumHits() override;
+  size_t GetNumMisses() override;
+  // optimistic child fetches that skipped the page table
+  size_t GetNumSwizzleHits();
 
-  Page *NewPage(page_id_t &page_id);
+  // spawn a thread that writes dirty pages out before they get evicted
+  void RunWriterThread();
+  void StopWriterThread();
 
-  bool DeletePage(page_id_t page_id);
+  // pages written by the background writer, and per second since it started
+  size_t GetNumPagesCleaned();
+  double GetWriterFlushRate();
+  // dirty victims FetchPage/NewPage had to write back themselves
+  size_t GetNumForegroundWrites();
+
+  void ReadAhead(page_id_t page_id, NextPageFunc next_page) override;
+  // pages read ahead per request, 0 turns read-ahead off
+  inline void SetPrefetchWindow(size_t window) { prefetch_window_ = window; }
+  inline size_t GetPrefetchWindow() const { return prefetch_window_; }
+  // pages read from disk by read-ahead
+  size_t GetNumPrefetched();
+  // stop the read-ahead thread, the requests still queued are dropped
+  void StopPrefetchThread();
+
+  // write the resident pages and their temperature to a warm-up image
+  bool SaveWarmImage(const std::string &file_name);
+  // fill free frames with the hottest pages of a warm-up image, read in
+  // page id order with large sequential reads; returns the pages loaded
+  size_t WarmUp(const std::string &file_name);
+  // the background writer saves an image there every WARM_IMAGE_DELAY and
+  // when it stops, empty turns it off
+  void SetWarmImageFile(const std::string &file_name);
+  // time the last WarmUp took in seconds
+  inline double GetWarmUpTime() const { return warm_up_time_; }
+
+  // keep clean pages evicted from the pool compressed in budget bytes, a
+  // miss then looks there before reading the disk; call before the pool is
+  // shared between threads
+  void EnableCompressedCache(size_t budget);
+  // pages served by the compressed tier / misses of the pool not found there
+  size_t GetNumCompressedHits();
+  size_t GetNumCompressedMisses();
+  // the compressed tier, nullptr if not enabled
+  inline CompressedCache *GetCompressedCache() {
+    return compressed_cache_.get();
+  }
+
+  // share the pages read from and written to disk with the other processes
+  // of the database through the shared memory segment name (created with
+  // num_pages slots if it does not exist), a miss then looks there before
+  // reading the disk; num_pages 0 turns it off. Call before the pool is
+  // shared between threads
+  void EnableSharedCache(const std::string &name, size_t num_pages);
+  // pages served by the shared cache / misses not found there
+  size_t GetNumSharedHits();
+  size_t GetNumSharedMisses();
+  // the shared cache, nullptr if not enabled
+  inline SharedPageCache *GetSharedCache() { return shared_cache_.get(); }
+
+  // the block holding the page contents
+  inline FrameArena *GetArena() { return &arena_; }
+
+  // the replacement policy, e.g. to read the counters of an ARCReplacer
+  inline Replacer<Page *> *GetReplacer() {
+    return partitions_[0]->replacers_[0]->GetReplacer();
+  }
+
+  // a named partition of the pool, with its own replacer: min_frames of the
+  // pool are kept for its pages, and it never holds more than max_frames (0
+  // for no limit). Pages created or read through it are its pages. A name
+  // already in use gives the existing partition. Throws if the minimum shares
+  // would not fit into the pool, or there are too many partitions
+  BufferPoolPartition *CreatePartition(const std::string &name,
+                                       size_t min_frames,
+                                       size_t max_frames = 0);
+  // nullptr if there is no partition by that name
+  BufferPoolPartition *GetPartition(const std::string &name);
+  // all the named partitions, e.g. to report their hit ratios
+  std::vector<BufferPoolPartition *> GetPartitions();
 
 private:
-  size_t pool_size_; // number of pages in buffer pool
-  Page *pages_;      // array of pages
+  // a share of the frames with its own replacers, one per priority;
+  // partition 0 is the default one, without a name or limits
+  struct Partition {
+    std::string name_;
+    size_t min_frames_;
+    size_t max_frames_;
+    BufferedReplacer<Page *> *replacers_[NUM_PAGE_PRIORITIES];
+    BufferPoolPartition *view_; // nullptr for the default partition
+    // guarded by latch_
+    size_t num_frames_; // frames holding its pages
+    size_t num_hits_;   // hits of the frames it no longer holds
+    size_t num_misses_;
+  };
+
+  // a chain to read ahead, and the pool (or partition) to read it into
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    NextPageFunc next_page_;
+    BufferPool *pool_;
+  };
+
+  // pick a frame from the free list first, then from the replacer of the
+  // partition, or of another partition above its share
+  Page *GetVictimPage(size_t partition = 0);
+  // a victim of the partition's own replacers, of the lowest priority
+  Page *TakeVictim(size_t partition);
+  // a victim of the partitions holding more than their minimum share
+  Page *StealVictim(size_t partition);
+  // the replacer of the partition and priority the frame belongs to
+  inline BufferedReplacer<Page *> *GetFrameReplacer(Page *frame) {
+    size_t frame_id = frame->frame_id_;
+    return partitions_[frames_.partition_ids_[frame_id]]
+        ->replacers_[frames_.priorities_[frame_id]];
+  }
+  // apply a hint to a frame the caller has pinned; the replacer of the new
+  // priority may still hold a history of the frame from an older page
+  inline void SetPriority(Page *frame, PagePriority priority) {
+    uint8_t value = static_cast<uint8_t>(priority);
+    if (priority != PagePriority::UNCHANGED &&
+        frames_.priorities_[frame->frame_id_] != value) {
+      frames_.priorities_[frame->frame_id_] = value;
+      GetFrameReplacer(frame)->Reset(frame);
+    }
+  }
+  // per partition counters, hits of the frames it holds included
+  size_t GetPartitionHits(size_t partition);
+  size_t GetPartitionMisses(size_t partition);
+  size_t GetPartitionFrames(size_t partition);
+  // reuse a frame of the ring for page_id, or grow the ring by a victim
+  Page *GetRingVictim(BufferRing *ring, page_id_t page_id,
+                      size_t partition = 0);
+  // pin a frame found without the latch, false if it no longer holds page_id
+  // or a shrink is taking it away
+  bool TryPin(Page *page, page_id_t page_id);
+  // drop one pin, the frame becomes evictable when the last one goes
+  void Unpin(Page *page);
+  // after the last pin of a frame went, wake a shrinking Resize() waiting on it
+  void NotifyUnpinned(Page *page);
+  // drop the swizzled references to and from a frame being reused
+  void Unswizzle(Page *frame);
+  // empty a frame a shrinking pool no longer has
+  void RetireFrame(Page *frame, std::unique_lock<std::mutex> &lck);
+  // FetchPage, or a read-ahead pin that is not counted as an access; a miss
+  // brings the page into partition
+  Page *PinPage(page_id_t page_id, bool prefetch, BufferRing *ring = nullptr,
+                size_t partition = 0);
+  // FetchFrame, a miss brings the page into partition
+  Page *PinFrame(Page *frame, page_id_t page_id, size_t partition);
+  // ReadAhead for pool, this one or a partition or parallel pool the chain
+  // starts in: the read-ahead thread pins the pages through it
+  void QueueReadAhead(page_id_t page_id, NextPageFunc next_page,
+                      BufferPool *pool);
+  Page *PrefetchPage(page_id_t page_id) override;
+  void ReleasePrefetched(Page *page) override;
+  // warm-up image content, and a page of it put into a free frame (pinned)
+  void GetResidentPages(std::vector<WarmPage> &pages);
+  Page *InstallPage(page_id_t page_id, const char *page_data);
+  // the warm-up image file format, shared with the parallel pool: write
+  // pages, and load the hottest pages of an image into num_frames frames
+  // through install, unpinned through pool afterwards
+  static bool WriteWarmImage(const std::string &file_name, size_t page_size,
+                             const std::vector<WarmPage> &pages);
+  static size_t
+  LoadWarmImage(const std::string &file_name, size_t page_size,
+                size_t num_frames, DiskManager *disk_manager,
+                const std::function<Page *(page_id_t, const char *)> &install,
+                BufferPool *pool);
+  // body of the read-ahead thread
+  void PrefetchLoop();
+  // one round of the background writer
+  void CleanPages();
+  // read page_id into a frame, from the compressed tier if it is there
+  void ReadPageIn(page_id_t page_id, char *page_data);
+  // write page data to disk, forcing the log out to its LSN first (WAL)
+  void WritePageOut(page_id_t page_id, const char *page_data);
+  // the same without waiting for the disk, page_data has to stay unchanged
+  // until the future is ready
+  std::future<void> WritePageOutAsync(page_id_t page_id,
+                                      const char *page_data);
+  // WAL: the log records up to the LSN of page_data are not on disk yet
+  bool WaitsForLog(page_id_t page_id, const char *page_data);
+  // WAL and the other cache tiers, before page_data goes to disk
+  void PrepareWriteOut(page_id_t page_id, const char *page_data);
+  // give the victim frame to page_id of partition and do its disk I/O
+  // without the latch
+  void ReplacePage(Page *frame, page_id_t page_id, bool read_page,
+                   size_t partition, std::unique_lock<std::mutex> &lck);
+  // a partition with replacers of replacer_type_ for all the frames
+  Partition *NewPartition(const std::string &name, size_t min_frames,
+                          size_t max_frames, BufferPoolPartition *view);
+  // move a claimed frame into partition at the lowest priority, settling the
+  // hits of the old one
+  void AssignFrame(Page *frame, size_t partition);
+  // NewPage in partition, the page id from extent unless it is nullptr
+  Page *NewPageIn(page_id_t &page_id, size_t partition,
+                  Extent *extent = nullptr);
+  // NewPage into the pool page_id picks, see NewPageWithId
+  static Page *
+  NewPageRouted(page_id_t &page_id, Extent *extent, DiskManager *disk_manager,
+                const std::function<Page *(page_id_t)> &new_page_with_id);
+  // map an already allocated page id onto a fresh zeroed frame of partition
+  Page *NewPageWithId(page_id_t page_id, size_t partition = 0);
+
+  std::atomic<size_t> pool_size_; // number of pages in buffer pool
+  size_t capacity_;  // number of frames set up, the most pool_size_ grows to
+  size_t page_size_; // size of a page in byte
+  // entries of a swizzle table: the most children an internal page can have,
+  // pairs of the smallest key (4 byte) and a page id filling it
+  size_t swizzle_slots_;
+  FrameTable frames_; // metadata of the frames
+  FrameArena arena_;  // content of all the pages
+  Page *pages_;       // array of pages
   DiskManager *disk_manager_;
   LogManager *log_manager_;
-  HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
-  Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
-  std::list<Page *> *free_list_; // to find a free page for replacement
-  std::mutex latch_;             // to protect shared data structure
+  PageTable<Page *> *page_table_; // to keep track of pages, lock-free Find
+  ReplacerType replacer_type_;    // policy of the partitions' replacers
+  // to find an unpinned page, one replacer per partition
+  Partition *partitions_[BUFFER_POOL_MAX_PARTITIONS];
+  std::atomic<size_t> num_partitions_;
+  std::list<Page *> *free_list_;       // to find a free page for replacement
+  std::mutex latch_;                   // to protect shared data structure
+  std::mutex resize_latch_;            // one Resize() at a time
+  std::condition_variable io_cv_;      // signaled when a frame's I/O is done
+  std::condition_variable unpin_cv_;   // signaled when a retired frame's last
+                                       // pin goes
+  std::unordered_set<page_id_t> flushing_; // evicted, write-back in progress
+  std::atomic<size_t> num_misses_;
+  std::atomic<size_t> num_foreground_writes_;
+  std::unique_ptr<CompressedCache> compressed_cache_; // second tier, optional
+  std::unique_ptr<SharedPageCache> shared_cache_;     // across processes
+
+  // background writer
+  std::thread *writer_thread_;
+  bool writer_running_;                // guarded by writer_latch_
+  std::mutex writer_latch_;
+  std::condition_variable writer_cv_;  // wakes the writer early or stops it
+  std::chrono::steady_clock::time_point writer_start_;
+  std::atomic<size_t> num_pages_cleaned_;
+  std::string warm_image_file_;        // guarded by writer_latch_
+  double warm_up_time_;
+
+  // read-ahead
+  std::thread *prefetch_thread_;
+  bool prefetch_running_;              // guarded by prefetch_latch_
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  std::deque<PrefetchRequest> prefetch_queue_;
+  std::atomic<size_t> prefetch_window_;
+  std::atomic<size_t> num_prefetched_;
 };
 } // namespace scudb
@@ -0,0 +1,91 @@
+/*
+ * buffer_pool_partition.h
+ *
+ * Functionality: A named partition of a buffer pool, made by
+ * BufferPoolManager::CreatePartition or
+ * ParallelBufferPoolManager::CreatePartition. It implements the BufferPool
+ * interface and can be handed to TableHeap/BPlusTree unchanged: the pages it
+ * creates or reads in go to frames of the partition, which has its own
+ * replacer, keeps a minimum share of the pool and never exceeds its quota.
+ * Hits and misses are counted per partition.
+ * A partition of a parallel pool is made of one share per instance, a page
+ * goes to the share of the instance its page id picks.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace scudb {
+class BufferPoolPartition : public BufferPool {
+  friend class ParallelBufferPoolManager;
+
+public:
+  // the part of the partition in one pool: the pool that owns the frames and
+  // the index the partition has there
+  struct Share {
+    BufferPoolManager *pool_;
+    size_t partition_;
+  };
+
+  // shares in the order of the instances of a parallel pool, a single one
+  // for a partition of a BufferPoolManager
+  BufferPoolPartition(const std::string &name, size_t min_frames,
+                      size_t max_frames, std::vector<Share> shares);
+
+  Page *FetchPage(page_id_t page_id,
+                  PagePriority priority = PagePriority::UNCHANGED) override;
+
+  Page *FetchPage(page_id_t page_id, BufferRing *ring) override;
+
+  Page *FetchPageOptimistic(page_id_t page_id, uint64_t &version) override;
+
+  Page *FetchChildOptimistic(Page *parent, int slot, page_id_t child_page_id,
+                             uint64_t &version) override;
+
+  Page *FetchFrame(Page *frame, page_id_t page_id) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty,
+                 PagePriority priority = PagePriority::UNCHANGED) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  Page *NewPage(page_id_t &page_id, Extent *extent) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  void ReadAhead(page_id_t page_id, NextPageFunc next_page) override;
+
+  // the frames the partition may hold: its quota, at most the pool
+  size_t GetPoolSize() override;
+  size_t GetPageSize() const override;
+
+  // FetchPage calls served from / read into the partition's frames
+  size_t GetNumHits() override;
+  size_t GetNumMisses() override;
+
+  inline const std::string &GetName() const { return name_; }
+  inline size_t GetMinFrames() const { return min_frames_; }
+  inline size_t GetMaxFrames() const { return max_frames_; }
+  // frames holding pages of the partition now
+  size_t GetNumFrames();
+  // hits per FetchPage call, 0 before the first one
+  double GetHitRatio();
+
+private:
+  Page *PrefetchPage(page_id_t page_id) override;
+  void ReleasePrefetched(Page *page) override;
+
+  // the share page_id belongs to
+  const Share &GetShare(page_id_t page_id) const;
+
+  std::string name_;
+  size_t min_frames_;
+  size_t max_frames_;
+  std::vector<Share> shares_;
+};
+} // namespace scudb
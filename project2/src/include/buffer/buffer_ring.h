@@ -0,0 +1,34 @@
+/**
+ * buffer_ring.h
+ *
+ * Functionality: The strategy ring of one large sequential scan. Instead of
+ * taking a victim from the whole pool for every page it reads, the scan
+ * recycles the few frames it already filled, so it does not push the working
+ * set of other queries out of the buffer pool.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "page/page.h"
+
+namespace scudb {
+
+class BufferRing {
+  friend class BufferPoolManager;
+
+public:
+  explicit BufferRing(size_t size = BUFFER_RING_SIZE) : size_(size), next_(0) {}
+
+  inline size_t GetSize() const { return size_; }
+
+private:
+  size_t size_;                     // most frames the scan may hold on to
+  std::vector<Page *> frames_;      // frames the scan filled
+  std::vector<page_id_t> page_ids_; // the page each frame was filled with
+  size_t next_;                     // slot to recycle next
+};
+
+} // namespace scudb
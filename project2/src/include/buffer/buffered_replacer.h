@@ -0,0 +1,82 @@
+/**
+ * buffered_replacer.h
+ *
+ * Functionality: Wraps another replacer so that pinning and unpinning do not
+ * touch its shared list. Whether a frame is evictable is kept in a per-frame
+ * atomic flag. Insert() sets the flag and Erase() (the FetchPage hit path)
+ * clears it, and both record the change in one of several striped lock-free
+ * ring buffers. The buffered changes are applied to the wrapped replacer in
+ * a batch when a stripe fills up, and always before a victim is chosen, so the
+ * wrapped policy sees the accesses in (approximately) the order they
+ * happened, and never offers a frame that is pinned.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace scudb {
+
+template <typename T> class BufferedReplacer : public Replacer<T> {
+public:
+  // takes ownership of replacer, num_frames is the number of frame slots
+  BufferedReplacer(Replacer<T> *replacer, size_t num_frames);
+
+  ~BufferedReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  bool PeekVictims(std::vector<T> &values, size_t max);
+
+  // make value a candidate again if Victim() dropped it while it was pinned
+  // by somebody who never called Erase(); keeps its place otherwise
+  void Reinsert(const T &value);
+
+  // applies everything buffered first
+  void Reset(const T &value);
+
+  // the wrapped replacement policy
+  inline Replacer<T> *GetReplacer() { return replacer_; }
+
+private:
+  static constexpr size_t STRIPE_COUNT = 4;
+  static constexpr size_t STRIPE_SIZE = 32;
+  // set in a slot for an Erase(), clear for an Insert()
+  static constexpr size_t ERASE_FLAG = ~(~size_t(0) >> 1);
+
+  // bounded multi-producer ring, consumed under drain_latch_ only
+  struct Stripe {
+    std::atomic<size_t> head;               // next slot to drain
+    std::atomic<size_t> tail;               // next slot to reserve
+    std::atomic<size_t> slots[STRIPE_SIZE]; // frame id + 1 (| ERASE_FLAG),
+                                            // 0 while unwritten
+    char padding[64]; // keep neighbouring stripes off each other's lines
+  };
+
+  // append an access (or with ERASE_FLAG a pin) to the calling thread's
+  // stripe
+  void Record(size_t slot);
+  // apply buffered changes to the wrapped replacer, caller holds drain_latch_
+  void DrainStripe(Stripe &stripe);
+  void DrainAll();
+
+  Replacer<T> *replacer_;
+  size_t num_frames_;
+  std::vector<T> values_; // value held by each frame
+  std::unique_ptr<std::atomic<bool>[]> in_use_; // frame can be evicted
+  std::unique_ptr<Stripe[]> stripes_;
+  std::mutex drain_latch_; // serialize draining and victim selection
+};
+
+} // namespace scudb
@@ -0,0 +1,48 @@
+/**
+ * clock_replacer.h
+ *
+ * Functionality: CLOCK (second chance) replacement over a fixed array of
+ * frames. Insert/Erase only flip per-frame atomic flags, so pinning and
+ * unpinning never allocate or take a lock; the latch is held only while the
+ * clock hand sweeps in Victim().
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace scudb {
+
+template <typename T> class ClockReplacer : public Replacer<T> {
+public:
+  // num_frames: number of frame slots, every value must map below it
+  explicit ClockReplacer(size_t num_frames);
+
+  ~ClockReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  bool PeekVictims(std::vector<T> &values, size_t max);
+
+private:
+  size_t num_frames_;
+  std::vector<T> values_;                       // value held by each frame
+  std::unique_ptr<std::atomic<bool>[]> in_use_; // frame can be evicted
+  std::unique_ptr<std::atomic<bool>[]> ref_;    // reference bit
+  std::atomic<size_t> size_;                    // number of evictable frames
+  size_t hand_;                                 // clock hand, under latch_
+  std::mutex latch_;                            // serialize sweeps
+};
+
+} // namespace scudb
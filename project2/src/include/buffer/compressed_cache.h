@@ -0,0 +1,74 @@
+/**
+ * compressed_cache.h
+ *
+ * Functionality: Second cache tier between the buffer pool and the disk.
+ * Clean pages evicted from the pool are kept here compressed
+ * (PageCompressor), a miss of the pool looks here before reading the disk.
+ * The tier holds the pages the pool does not: a page found here moves back
+ * into the pool and leaves the tier. It has its own memory budget and evicts
+ * its least recently stored page when that is exceeded. Pages that do not
+ * compress by at least 1/COMPRESSED_CACHE_MIN_SAVING are not kept.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace scudb {
+
+class CompressedCache {
+public:
+  // budget: bytes the compressed pages (and their bookkeeping) may take
+  CompressedCache(size_t budget, size_t page_size);
+
+  // keep a compressed copy of a page that is the same on disk, false if it
+  // does not compress well enough or is larger than the budget
+  bool Put(page_id_t page_id, const char *page_data);
+  // move page_id out of the tier into page_data, false on a miss
+  bool Get(page_id_t page_id, char *page_data);
+  // forget page_id, e.g. because a newer version went to disk
+  void Erase(page_id_t page_id);
+
+  inline size_t GetBudget() const { return budget_; }
+  size_t GetMemoryUsage();
+  size_t GetNumPages();
+  // Get calls served from the tier / not
+  inline size_t GetNumHits() const { return num_hits_; }
+  inline size_t GetNumMisses() const { return num_misses_; }
+  // pages dropped to stay within the budget, pages not kept by Put
+  inline size_t GetNumEvictions() const { return num_evictions_; }
+  inline size_t GetNumRejected() const { return num_rejected_; }
+
+private:
+  struct Entry {
+    page_id_t page_id;
+    size_t size;
+    std::unique_ptr<char[]> data;
+  };
+  // memory taken by an entry, the compressed page plus list and map nodes
+  inline size_t EntryMemory(const Entry &entry) const {
+    return entry.size + sizeof(Entry) + 4 * sizeof(void *) +
+           sizeof(std::pair<page_id_t, std::list<Entry>::iterator>);
+  }
+  // drop an entry, caller holds latch_
+  void RemoveEntry(std::list<Entry>::iterator entry);
+
+  size_t budget_;
+  size_t page_size_;
+  size_t memory_usage_; // guarded by latch_
+  std::list<Entry> lru_; // most recently stored first
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> entries_;
+  std::mutex latch_;
+  std::atomic<size_t> num_hits_;
+  std::atomic<size_t> num_misses_;
+  std::atomic<size_t> num_evictions_;
+  std::atomic<size_t> num_rejected_;
+};
+
+} // namespace scudb
@@ -0,0 +1,39 @@
+/**
+ * frame_arena.h
+ *
+ * Functionality: One block of memory holding the page contents of a buffer
+ * pool. It is mapped with mmap, so it starts on a 4K boundary; with page sizes
+ * being multiples of 4K every frame is aligned well enough for O_DIRECT I/O.
+ * Large arenas are backed by huge pages when the system offers them, which
+ * saves TLB misses when scanning the pool. Memory is only committed when a
+ * frame is first touched, so an arena can be reserved for more frames than are
+ * in use, and the memory of unused frames can be given back.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace scudb {
+
+class FrameArena {
+public:
+  explicit FrameArena(size_t size);
+  ~FrameArena();
+
+  inline char *GetData() { return data_; }
+  inline size_t GetSize() const { return size_; }
+  // mapped from explicit huge pages, or advised to use transparent ones
+  inline bool IsHugePageBacked() const { return huge_pages_; }
+  // give the memory of [offset, offset + size) back to the system, it stays
+  // mapped and reads as zeros
+  bool Release(size_t offset, size_t size);
+
+private:
+  char *data_;
+  size_t size_;
+  size_t mapped_size_;
+  bool huge_pages_;
+};
+
+} // namespace scudb
@@ -0,0 +1,55 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: LRU-K replacement. Every frame remembers the timestamps of
+ * its last K accesses (an access is recorded each time the page is unpinned
+ * back into the replacer). The victim is the frame whose K-th most recent
+ * access lies furthest in the past. Frames with fewer than K recorded
+ * accesses count as infinitely old and go first, oldest last access breaking
+ * ties, so pages touched once by a scan cannot push out the working set.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace scudb {
+
+template <typename T> class LRUKReplacer : public Replacer<T> {
+public:
+  // num_frames: number of frame slots, every value must map below it
+  explicit LRUKReplacer(size_t num_frames, size_t k = 2);
+
+  ~LRUKReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void Reset(const T &value);
+
+private:
+  // timestamp of the i-th access (counting from 0) recorded for frame_id
+  inline size_t &History(size_t frame_id, size_t i) {
+    return history_[frame_id * k_ + i % k_];
+  }
+
+  size_t num_frames_;
+  size_t k_;
+  size_t current_timestamp_;
+  size_t size_;                // number of evictable frames
+  std::vector<T> values_;      // value held by each frame
+  std::vector<bool> in_use_;   // frame can be evicted
+  std::vector<size_t> count_;  // accesses recorded since the frame was loaded
+  std::vector<size_t> history_; // last k access timestamps of every frame
+  std::mutex latch_;
+};
+
+} // namespace scudb
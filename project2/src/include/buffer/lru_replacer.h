@@ -5,20 +5,25 @@
  * all the pages that are unpinned and ready to be swapped. The simplest way to
  * implement LRU is a FIFO queue, but remember to dequeue or enqueue pages when
  * a page changes from unpinned to pinned, or vice-versa.
+ *
+ * The list is intrusive: prev/next links are frame indices kept in arrays
+ * sized to the number of frames, so Insert/Erase/Victim are O(1) and never
+ * allocate or hash, and the footprint is fixed at construction.
  */
 
 #pragma once
 
+#include <mutex>
+#include <vector>
+
 #include "buffer/replacer.h"
-#include "hash/extendible_hash.h"
-#include <unordered_map>
 
 namespace scudb {
 
 template <typename T> class LRUReplacer : public Replacer<T> {
 public:
-  // do not change public interface
-  LRUReplacer();
+  // num_frames: number of frame slots, every value must map below it
+  explicit LRUReplacer(size_t num_frames);
 
   ~LRUReplacer();
 
@@ -30,21 +35,19 @@ public:
 
   size_t Size();
 
+  bool PeekVictims(std::vector<T> &values, size_t max);
+
 private:
-  // add your member variables here
-  struct node
-  {
-    node() {}
-    node(T val) : data(val) {}
-    T data;
-    node *prev = nullptr;
-    node *next = nullptr;
-  };
-  mutable std::mutex mtx; //insure thread safety
-  node* head; //head node
-  node* tail; //tail node
-  size_t pSize; //the number of pages
-  std::unordered_map<T, node*> pages;
+  // unlink frame_id from the list, caller must hold mtx
+  void Unlink(size_t frame_id);
+
+  size_t num_frames_;       // slot num_frames_ is the list head sentinel
+  std::vector<size_t> prev_; // towards the most recently used end
+  std::vector<size_t> next_; // towards the least recently used end
+  std::vector<bool> in_list_;
+  std::vector<T> values_;    // value held by each frame
+  size_t size_;              // the number of pages
+  std::mutex mtx;            // insure thread safety
 };
 
 } // namespace scudb
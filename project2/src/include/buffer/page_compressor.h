@@ -0,0 +1,35 @@
+/**
+ * page_compressor.h
+ *
+ * Functionality: A small LZ77 codec for page images, built for speed rather
+ * than ratio (in the spirit of LZ4). The output is a list of sequences, each
+ * a token byte (literal length << 4 | match length - 4), the literal bytes,
+ * a 2 byte little endian offset back into the output and, for lengths of 15
+ * and more, extra length bytes (runs of 255). The last sequence has literals
+ * only. Matches are found through a hash table of 4 byte prefixes.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace scudb {
+
+class PageCompressor {
+public:
+  // compress size bytes of src into dst, return the compressed size, or 0 if
+  // it does not fit into capacity bytes
+  static size_t Compress(const char *src, size_t size, char *dst,
+                         size_t capacity);
+  // decompress size bytes of src into exactly dst_size bytes of dst, false
+  // if the input is corrupt
+  static bool Decompress(const char *src, size_t size, char *dst,
+                         size_t dst_size);
+
+private:
+  static constexpr size_t MIN_MATCH = 4;
+  static constexpr size_t MAX_OFFSET = 65535;
+  static constexpr size_t HASH_BITS = 12;
+};
+
+} // namespace scudb
@@ -0,0 +1,148 @@
+/*
+ * parallel_buffer_pool_manager.h
+ *
+ * Functionality: Shards the buffer pool into several independent
+ * BufferPoolManager instances. Every instance owns its own page table,
+ * replacer, free list and latch, and a page always lives in the instance
+ * picked by its page id, so threads touching different pages do not
+ * serialize on one latch. It implements the BufferPool interface and can be
+ * handed to TableHeap/BPlusTree unchanged; running the pool (resizing, the
+ * background threads, the cache tiers, partitions) is done on all of the
+ * instances at once, and the counters are summed over them.
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_partition.h"
+
+namespace scudb {
+class ParallelBufferPoolManager : public BufferPool {
+public:
+  // pool_size (and max_pool_size) is the total number of frames, split
+  // evenly among instances
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                            DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t max_pool_size = 0);
+
+  ~ParallelBufferPoolManager();
+
+  Page *FetchPage(page_id_t page_id,
+                  PagePriority priority = PagePriority::UNCHANGED) override;
+
+  Page *FetchPage(page_id_t page_id, BufferRing *ring) override;
+
+  Page *FetchPageOptimistic(page_id_t page_id, uint64_t &version) override;
+
+  // swizzled references live in the instance of the child
+  Page *FetchChildOptimistic(Page *parent, int slot, page_id_t child_page_id,
+                             uint64_t &version) override;
+
+  Page *FetchFrame(Page *frame, page_id_t page_id) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty,
+                 PagePriority priority = PagePriority::UNCHANGED) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  // the page id is allocated first, it picks the instance
+  Page *NewPage(page_id_t &page_id) override;
+
+  Page *NewPage(page_id_t &page_id, Extent *extent) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  // the read-ahead thread of the first page's instance walks the chain, each
+  // page goes to its instance
+  void ReadAhead(page_id_t page_id, NextPageFunc next_page) override;
+
+  // summed over all instances
+  size_t GetPoolSize() override;
+  size_t GetMaxPoolSize();
+  size_t GetMemoryUsage();
+  // every instance takes its share of new_size
+  void Resize(size_t new_size);
+  // the same in every instance, fixed by the database file
+  size_t GetPageSize() const override;
+
+  size_t GetNumHits() override;
+  size_t GetNumMisses() override;
+  size_t GetNumSwizzleHits();
+
+  // every instance runs its own writer; this pool saves the warm-up image
+  // of all of them
+  void RunWriterThread();
+  void StopWriterThread();
+  size_t GetNumPagesCleaned();
+  double GetWriterFlushRate();
+  size_t GetNumForegroundWrites();
+
+  // set in every instance
+  void SetPrefetchWindow(size_t window);
+  inline size_t GetPrefetchWindow() const { return prefetch_window_; }
+  size_t GetNumPrefetched();
+  void StopPrefetchThread();
+
+  // the image covers all the instances, and a page of it is loaded into the
+  // instance its page id picks
+  bool SaveWarmImage(const std::string &file_name);
+  size_t WarmUp(const std::string &file_name);
+  void SetWarmImageFile(const std::string &file_name);
+  inline double GetWarmUpTime() const { return warm_up_time_; }
+
+  // every instance gets a tier with its share of budget
+  void EnableCompressedCache(size_t budget);
+  size_t GetNumCompressedHits();
+  size_t GetNumCompressedMisses();
+  // every instance attaches to the segment, it is not split
+  void EnableSharedCache(const std::string &name, size_t num_pages);
+  size_t GetNumSharedHits();
+  size_t GetNumSharedMisses();
+
+  // a partition spanning the instances: each of them gets a partition of
+  // the name with its share of min_frames and max_frames. If an instance
+  // throws, the instances before it keep theirs, a retry picks them up
+  BufferPoolPartition *CreatePartition(const std::string &name,
+                                       size_t min_frames,
+                                       size_t max_frames = 0);
+  BufferPoolPartition *GetPartition(const std::string &name);
+  std::vector<BufferPoolPartition *> GetPartitions();
+
+  // the tiers, arena, replacer and partitions of a single instance are
+  // reached through it
+  inline size_t GetNumInstances() const { return instances_.size(); }
+  inline BufferPoolManager *GetInstanceAt(size_t i) { return instances_[i]; }
+
+private:
+  Page *PrefetchPage(page_id_t page_id) override;
+  void ReleasePrefetched(Page *page) override;
+
+  // the frames of the i-th instance when num_frames are split among them
+  size_t GetShare(size_t num_frames, size_t i) const;
+
+  // the instance responsible for page_id
+  BufferPoolManager *GetInstance(page_id_t page_id);
+
+  std::vector<BufferPoolManager *> instances_;
+  DiskManager *disk_manager_;
+  std::atomic<size_t> prefetch_window_;
+  std::mutex latch_; // guards partitions_
+  std::vector<BufferPoolPartition *> partitions_;
+
+  // saves the warm-up image every WARM_IMAGE_DELAY while the writers run
+  std::thread *image_thread_;
+  bool image_running_;                 // guarded by image_latch_
+  std::mutex image_latch_;
+  std::condition_variable image_cv_;   // stops the image thread
+  std::string warm_image_file_;        // guarded by image_latch_
+  double warm_up_time_;
+};
+} // namespace scudb
@@ -6,9 +6,35 @@
 #pragma once
 
 #include <cstdlib>
+#include <vector>
+
+#include "page/page.h"
 
 namespace scudb {
 
+/*
+ * Replacers that keep per-frame state in a fixed array need the frame slot a
+ * value lives in. Pages carry the slot the buffer pool gave them; the plain
+ * integers used by the tests are their own slot.
+ */
+template <typename T> inline size_t FrameIdOf(const T &value) {
+  return static_cast<size_t>(value);
+}
+template <> inline size_t FrameIdOf<Page *>(Page *const &page) {
+  return page->GetFrameId();
+}
+
+/*
+ * Replacers that remember evicted pages (ghost entries) need to know which
+ * page a value holds, the frame alone is reused by other pages.
+ */
+template <typename T> inline page_id_t PageIdOf(const T &value) {
+  return static_cast<page_id_t>(value);
+}
+template <> inline page_id_t PageIdOf<Page *>(Page *const &page) {
+  return page->GetPageId();
+}
+
 template <typename T> class Replacer {
 public:
   Replacer() {}
@@ -17,6 +43,15 @@ public:
   virtual bool Victim(T &value) = 0;
   virtual bool Erase(const T &value) = 0;
   virtual size_t Size() = 0;
+  // append up to max values Victim() is likely to pick next, most likely
+  // first, without evicting them. return false if the policy cannot tell
+  virtual bool PeekVictims(std::vector<T> &values, size_t max) {
+    return false;
+  }
+  // forget what was recorded for the frame of value, which is not evictable:
+  // it gets another page, or comes back from another replacer. Policies
+  // without a history keep nothing to forget
+  virtual void Reset(const T &value) {}
 };
 
 } // namespace scudb
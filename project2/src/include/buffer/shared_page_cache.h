@@ -0,0 +1,114 @@
+/**
+ * shared_page_cache.h
+ *
+ * Functionality: Page cache in a POSIX shared memory segment, shared by all
+ * the processes (and buffer pools) that open the same database. It holds
+ * copies of pages as they are on disk: a page read from disk or written to
+ * it is stored here, a miss of a pool looks here before reading the disk.
+ * The segment outlives the processes, so a process started later attaches
+ * to a cache that is already warm.
+ * The segment keeps its own page table (a chained hash table over slot
+ * indexes, no pointers) and a clock replacer, guarded by a process-shared
+ * robust mutex: a process dying while holding it only costs the cached
+ * pages, the next one to lock it starts over with an empty cache.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <pthread.h>
+#include <string>
+
+#include "common/config.h"
+
+namespace scudb {
+
+class SharedPageCache {
+public:
+  // attach to the segment name, creating it with num_pages slots if it does
+  // not exist yet; an existing segment keeps its size. db_file identifies
+  // the database, a segment left by another file with that name is emptied.
+  // Throws if the segment cannot be mapped or has another page size
+  SharedPageCache(const std::string &name, size_t num_pages, size_t page_size,
+                  const std::string &db_file);
+  ~SharedPageCache();
+
+  // store the disk version of a page, replacing an older copy
+  void Put(page_id_t page_id, const char *page_data);
+  // copy page_id into page_data, false on a miss
+  bool Get(page_id_t page_id, char *page_data);
+  // forget page_id, e.g. because it was deallocated
+  void Erase(page_id_t page_id);
+
+  // segment name for a database file, the same for every process using it
+  static std::string GetSegmentName(const std::string &db_file);
+  // remove the segment, it goes away once the last process detaches
+  static void Remove(const std::string &name);
+
+  inline const std::string &GetName() const { return name_; }
+  // the segment was created by another process (or pool) before this one
+  inline bool IsAttached() const { return attached_; }
+  inline size_t GetNumSlots() const { return num_slots_; }
+  size_t GetNumPages();
+  // Get calls of this process served from the segment / not
+  inline size_t GetNumHits() const { return num_hits_; }
+  inline size_t GetNumMisses() const { return num_misses_; }
+
+private:
+  struct Header {
+    std::atomic<uint32_t> magic; // set last, when the segment is ready
+    uint32_t page_size;
+    uint64_t num_slots;
+    uint64_t num_buckets;
+    uint64_t db_device;          // identity of the database file
+    uint64_t db_inode;
+    uint64_t clock_hand;
+    uint64_t num_pages;
+    pthread_mutex_t mutex;
+  };
+  struct Slot {
+    page_id_t page_id;
+    int32_t next;                // next slot in the bucket, -1 at the end
+    uint8_t referenced;          // clock reference bit
+  };
+
+  inline size_t GetBucket(page_id_t page_id) const {
+    return static_cast<uint32_t>(page_id) % num_buckets_;
+  }
+  inline char *GetSlotData(size_t slot) {
+    return data_ + slot * page_size_;
+  }
+  // bytes of a segment with num_slots slots
+  static size_t GetSegmentSize(size_t num_slots, size_t page_size);
+  // point the members into the mapped segment
+  void MapLayout();
+
+  // lock the segment's mutex, emptying the cache if its owner died
+  void Lock();
+  void Unlock();
+  // drop all the pages, caller holds the mutex
+  void Clear();
+  // slot holding page_id or -1, caller holds the mutex
+  int32_t FindSlot(page_id_t page_id);
+  // unlink a slot from its bucket and free it, caller holds the mutex
+  void RemoveSlot(int32_t slot);
+  // a free slot, or one freed by the clock, caller holds the mutex
+  int32_t GetVictimSlot();
+
+  std::string name_;
+  bool attached_;
+  size_t page_size_;
+  size_t num_slots_;
+  size_t num_buckets_;
+  size_t segment_size_;
+  char *segment_;                // the mapping
+  Header *header_;
+  int32_t *buckets_;             // first slot of every bucket
+  Slot *slots_;
+  char *data_;                   // the page copies, one per slot
+  std::atomic<size_t> num_hits_;
+  std::atomic<size_t> num_misses_;
+};
+
+} // namespace scudb
@@ -16,15 +16,45 @@ extern std::chrono::duration<long long int> LOG_TIMEOUT;
 
 extern std::atomic<bool> ENABLE_LOGGING;
 
+// pause between two rounds of the buffer pool's background writer
+extern std::chrono::milliseconds BG_WRITER_DELAY;
+
+// pause between two warm-up images saved by the background writer
+extern std::chrono::milliseconds WARM_IMAGE_DELAY;
+
 #define INVALID_PAGE_ID -1 // representing an invalid page id
 #define INVALID_TXN_ID -1  // representing an invalid txn id
 #define INVALID_LSN -1     // representing an invalid lsn
 #define HEADER_PAGE_ID 0   // the header page id
-#define PAGE_SIZE 512     // size of a data page in byte
-#define LOG_BUFFER_SIZE                                                            \
-  ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
+#define PAGE_SIZE 4096     // page size of a new database in byte
+#define MIN_PAGE_SIZE 4096 // a database page size is a power of two
+#define MAX_PAGE_SIZE 32768 // between MIN_PAGE_SIZE and MAX_PAGE_SIZE
+#define DB_FORMAT_MAGIC 0x53435544 // marks a header page holding the page size
+#define DB_FORMAT_SPACE_MAPS 0x1   // header page flag: file has space maps
+#define SPACE_MAP_MAGIC 0x5343534d // marks a space map page
+#define SPACE_MAP_GROUP_PAGES 4096 // pages per space map page, itself the last
+#define LOG_BUFFER_SIZE(pool_size, page_size)                                  \
+  (((pool_size) + 1) * (page_size)) // size of a log buffer in byte
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
-#define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define BUFFER_POOL_SIZE 10            // default size of buffer pool
+#define BG_WRITER_MAX_PAGES 8          // victims the bg writer checks per round
+#define PREFETCH_WINDOW 4              // default read-ahead window in pages
+#define PREFETCH_MAX_REQUESTS 16       // pending read-ahead requests kept
+#define BUFFER_RING_SIZE 8             // frames recycled by a large scan
+#define SCAN_RING_THRESHOLD 4          // ring scan above 1/4 of the pool
+#define OPTIMISTIC_READ_RETRIES 8      // conflicts before readers take latches
+#define WARM_IMAGE_MAGIC 0x5343574d    // marks a buffer pool warm-up image
+#define WARM_UP_MAX_RUN 64             // pages per sequential warm-up read
+#define COMPRESSED_CACHE_MIN_SAVING 8  // compressed tier keeps pages saving 1/8
+#define SHARED_CACHE_MAGIC 0x53435348  // marks a ready shared page cache segment
+#define BUFFER_POOL_MAX_PARTITIONS 16  // partitions of a pool, the default one too
+#define HUGE_PAGE_SIZE (2 << 20)       // size of a (x86-64) huge page
+#define ARENA_HUGE_PAGES 1   // advise transparent huge pages for frame arenas
+#define ARENA_HUGETLB 0      // try reserved (hugetlbfs) huge pages first
+#define DISK_IO_URING 1        // asynchronous disk I/O on io_uring if available
+#define DISK_IO_QUEUE_DEPTH 64 // asynchronous disk I/Os in flight
+#define DISK_IO_THREADS 8      // threads of the I/O fallback without io_uring
+#define EXTENT_PAGES 64        // contiguous pages reserved at once for a table
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
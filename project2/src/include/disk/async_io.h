@@ -0,0 +1,43 @@
+/**
+ * async_io.h
+ *
+ * Functionality: Asynchronous positional file I/O. A caller submits reads and
+ * writes and goes on; the callback of a request runs (on a thread of the
+ * engine) once all of it is done, so many requests can be in flight at once.
+ * Create() picks io_uring and falls back to a pool of threads doing
+ * pread/pwrite where io_uring is not available.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <sys/types.h>
+
+namespace scudb {
+
+enum class IOOp { READ, WRITE };
+
+class AsyncIO {
+public:
+  // result: the bytes transferred (fewer than asked for only when a read hits
+  // the end of the file), or -errno
+  typedef std::function<void(ssize_t result)> IOCallback;
+
+  virtual ~AsyncIO() {}
+
+  // queue the transfer of size bytes at offset of fd, blocks while
+  // GetQueueDepth() requests are in flight; data has to stay valid until
+  // the callback ran
+  virtual void Submit(IOOp op, int fd, char *data, size_t size, off_t offset,
+                      IOCallback callback) = 0;
+
+  // the engine's name, e.g. for a benchmark
+  virtual const char *GetName() const = 0;
+  virtual size_t GetQueueDepth() const = 0;
+
+  // an io_uring engine if the kernel offers one, a thread pool otherwise
+  static std::unique_ptr<AsyncIO> Create(size_t queue_depth);
+};
+
+} // namespace scudb
@@ -5,31 +5,84 @@
  * database. It also performs read and write of pages to and from disk, and
  * provides a logical file layer within the context of a database management
  * system.
+ *
+ * Free pages are recorded in space map pages: the last page of every group of
+ * SPACE_MAP_GROUP_PAGES pages is a bitmap of the pages of the group that were
+ * deallocated. It is only written once the group has a free page, a file
+ * without deallocations holds no space map at all. A file has space maps if
+ * it was created with them, its header page says so (DB_FORMAT_SPACE_MAPS);
+ * in an older one pages are never reused.
+ *
+ * Tables and indexes take their pages from extents (see disk/extent.h): runs
+ * of contiguous pages reserved at once, so that the pages of one of them
+ * stay together in the file while others grow at the same time.
  */
 
 #pragma once
 #include <atomic>
 #include <fstream>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "disk/async_io.h"
 
 namespace scudb {
 
 class DiskManager {
 public:
-  DiskManager(const std::string &db_file);
+  // page_size is used for a new database, an existing one keeps the page
+  // size recorded in its header page
+  DiskManager(const std::string &db_file, size_t page_size = PAGE_SIZE);
   ~DiskManager();
 
+  inline size_t GetPageSize() const { return page_size_; }
+  inline const std::string &GetFileName() const { return file_name_; }
+  // the file holds a database of an older version, whose header page and
+  // page size this one cannot read
+  inline bool IsOlderFormat() const { return older_format_; }
+
+  // positional I/O on the database file, safe to call from several threads
+  // at once; a written page reaches the OS, Sync makes it durable
   void WritePage(page_id_t page_id, const char *page_data);
   void ReadPage(page_id_t page_id, char *page_data);
+  // one sequential read of num_pages pages, returns how many are in the file
+  int ReadPages(page_id_t page_id, int num_pages, char *page_data);
+  // force the pages written so far to disk
+  void Sync();
+
+  // asynchronous page I/O, up to DISK_IO_QUEUE_DEPTH in flight: the future
+  // is ready once the transfer is done, page_data has to stay valid until
+  // then. A read past the end of the file zero-fills, ReadPagesAsync yields
+  // how many of the pages are in the file
+  std::future<void> ReadPageAsync(page_id_t page_id, char *page_data);
+  std::future<void> WritePageAsync(page_id_t page_id, const char *page_data);
+  std::future<int> ReadPagesAsync(page_id_t page_id, int num_pages,
+                                  char *page_data);
+  // the engine doing the asynchronous I/O, started on first use
+  AsyncIO *GetAsyncIO();
 
   void WriteLog(char *log_data, int size);
   bool ReadLog(char *log_data, int size, int offset);
 
+  // the lowest free page if there is one, a page past the used ones
+  // otherwise
   page_id_t AllocatePage();
+  // record page_id as free in its space map page, for reuse
   void DeallocatePage(page_id_t page_id);
+  // reserve a run of up to num_pages contiguous pages, free ones if there is
+  // such a run, past the used ones otherwise; a run ends before a space map
+  // page. Returns its first page, num_pages is set to its length
+  page_id_t AllocateExtent(int &num_pages);
+  // give back the pages of a run reserved by AllocateExtent but not used
+  void DeallocateExtent(page_id_t first_page_id, int num_pages);
+  size_t GetNumFreePages();
+  // the page ids in use are below it
+  page_id_t GetNextPageId();
 
   int GetNumFlushes() const;
   bool GetFlushState() const;
@@ -38,13 +91,37 @@ public:
 
 private:
   int GetFileSize(const std::string &name);
+  static inline bool IsSpaceMapPage(page_id_t page_id) {
+    return page_id % SPACE_MAP_GROUP_PAGES == SPACE_MAP_GROUP_PAGES - 1;
+  }
+  // set the bit of page_id in its group's space map page and write it, a
+  // group without a map gets one only when a page becomes free. Caller holds
+  // allocation_latch_
+  void UpdateSpaceMap(page_id_t page_id, bool is_free);
+  // UpdateSpaceMap without the write, returns whether the group has a map
+  bool MarkSpaceMap(page_id_t page_id, bool is_free);
+  // write the space map page of page_id's group
+  void WriteSpaceMap(page_id_t page_id);
+  // find the space map pages of an existing file, rebuilding next_page_id_
+  // and free_pages_
+  void LoadSpaceMaps();
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // pread/pwrite the db file, no shared file position
+  int db_fd_;
+  std::unique_ptr<AsyncIO> async_io_;
+  std::once_flag async_io_flag_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  size_t page_size_;
+  // allocation state, guarded by allocation_latch_
+  std::mutex allocation_latch_;
+  page_id_t next_page_id_;
+  std::set<page_id_t> free_pages_;  // lowest first
+  // false for a file from before space maps: pages are then never reused
+  bool space_maps_enabled_;
+  bool older_format_;
+  std::vector<std::unique_ptr<char[]>> space_maps_; // by group, or nullptr
   int num_flushes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
@@ -0,0 +1,47 @@
+/**
+ * extent.h
+ *
+ * Functionality: The pages reserved for one table or index. Its new pages
+ * come from a run of contiguous pages reserved at once, and a new run is
+ * reserved once that one is used up, so the pages of a table stay in file
+ * order even while other tables grow at the same time: a scan or read-ahead
+ * along them reads contiguous ranges of the file.
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "common/config.h"
+
+namespace scudb {
+
+class DiskManager;
+
+class Extent {
+public:
+  // reserve runs of num_pages pages
+  explicit Extent(int num_pages = EXTENT_PAGES);
+
+  // the next page of the run, reserving a new run from disk_manager when it
+  // is used up
+  page_id_t AllocatePage(DiskManager *disk_manager);
+  // undo the last AllocatePage, which returned page_id
+  void DeallocatePage(page_id_t page_id);
+  // give the pages reserved but not used back to the disk manager; the
+  // reservation is not on disk, pages not given back by the time the
+  // database is closed are only reclaimed at the end of the file
+  void Release();
+
+  // reserved pages not used yet
+  int GetNumFreePages();
+
+private:
+  std::mutex latch_;
+  int num_pages_;
+  DiskManager *disk_manager_; // the run is reserved from
+  page_id_t next_page_id_;    // of the run
+  page_id_t end_page_id_;
+};
+
+} // namespace scudb
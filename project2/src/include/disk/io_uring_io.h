@@ -0,0 +1,75 @@
+/**
+ * io_uring_io.h
+ *
+ * Functionality: AsyncIO on a Linux io_uring, set up with the raw system
+ * calls (no liburing). Submitters fill the submission ring under a latch and
+ * enter the kernel; one completion thread waits on the completion ring,
+ * resubmits the rest of short transfers and runs the callbacks.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <thread>
+
+#include "disk/async_io.h"
+
+namespace scudb {
+
+class IOUringIO : public AsyncIO {
+public:
+  // throws if the kernel does not offer io_uring
+  explicit IOUringIO(size_t queue_depth);
+  ~IOUringIO();
+
+  void Submit(IOOp op, int fd, char *data, size_t size, off_t offset,
+              IOCallback callback) override;
+
+  inline const char *GetName() const override { return "io_uring"; }
+  inline size_t GetQueueDepth() const override { return queue_depth_; }
+
+private:
+  struct Request {
+    IOOp op;
+    int fd;
+    char *data;
+    size_t size;
+    off_t offset;
+    size_t done;               // bytes transferred so far
+    IOCallback callback;
+  };
+
+  // put the rest of request into the submission ring and enter the kernel;
+  // request == nullptr asks the completion thread to stop
+  void Enqueue(Request *request);
+  // the completion thread
+  void ReapLoop();
+
+  size_t queue_depth_;
+  int ring_fd_;
+  // the rings shared with the kernel
+  void *sq_ring_;
+  size_t sq_ring_size_;
+  void *cq_ring_;
+  size_t cq_ring_size_;
+  io_uring_sqe *sqes_;
+  size_t sqes_size_;
+  uint32_t *sq_tail_;
+  uint32_t *sq_mask_;
+  uint32_t *sq_array_;
+  uint32_t *cq_head_;
+  uint32_t *cq_tail_;
+  uint32_t *cq_mask_;
+  io_uring_cqe *cqes_;
+
+  std::mutex submit_latch_;    // one submitter fills the ring at a time
+  std::condition_variable slot_cv_; // signaled when a request completes
+  size_t num_in_flight_;       // guarded by submit_latch_
+  std::thread *reaper_;
+};
+
+} // namespace scudb
@@ -0,0 +1,54 @@
+/**
+ * thread_pool_io.h
+ *
+ * Functionality: AsyncIO fallback for systems without io_uring. A fixed pool
+ * of threads takes the queued requests and does them with blocking
+ * pread/pwrite, so as many transfers are in flight as there are threads.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "disk/async_io.h"
+
+namespace scudb {
+
+class ThreadPoolIO : public AsyncIO {
+public:
+  ThreadPoolIO(size_t queue_depth, size_t num_threads);
+  ~ThreadPoolIO();
+
+  void Submit(IOOp op, int fd, char *data, size_t size, off_t offset,
+              IOCallback callback) override;
+
+  inline const char *GetName() const override { return "thread pool"; }
+  inline size_t GetQueueDepth() const override { return queue_depth_; }
+
+private:
+  struct Request {
+    IOOp op;
+    int fd;
+    char *data;
+    size_t size;
+    off_t offset;
+    IOCallback callback;
+  };
+
+  void WorkerLoop();
+
+  size_t queue_depth_;
+  std::deque<Request> queue_;   // guarded by latch_
+  size_t num_in_flight_;        // queued or running, guarded by latch_
+  bool running_;                // guarded by latch_
+  std::mutex latch_;
+  std::condition_variable work_cv_;  // signaled when a request is queued
+  std::condition_variable slot_cv_;  // signaled when a request completes
+  std::vector<std::thread> workers_;
+};
+
+} // namespace scudb
@@ -0,0 +1,65 @@
+/*
+ * page_table.h : concurrent hash table from page id to frame
+ *
+ * Functionality: Fixed size open addressing table (linear probing, backward
+ * shift deletion) sized for at most max_size entries, the number of frames in
+ * the buffer pool. Find() is lock-free and writes nothing shared: it probes
+ * the atomic slots and validates the probe against the sequence counters of
+ * the groups of slots it read, which writers bump around their changes
+ * (seqlocks, one per VERSION_GROUP_SLOTS slots). Only a lookup that read a
+ * slot a writer changes meanwhile is retried, lookups elsewhere in the table
+ * neither wait for writers nor share a counter's cache line. Insert() and
+ * Remove() are serialized by a latch.
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "common/config.h"
+#include "hash/hash_table.h"
+
+namespace scudb {
+
+template <typename V> class PageTable : public HashTable<page_id_t, V> {
+public:
+  // max_size: maximum number of entries the table will ever hold
+  explicit PageTable(size_t max_size);
+  // lookup and modifier
+  bool Find(const page_id_t &key, V &value) override;
+  bool Remove(const page_id_t &key) override;
+  void Insert(const page_id_t &key, const V &value) override;
+  size_t Size();
+
+private:
+  static constexpr size_t VERSION_GROUP_SLOTS = 8;
+  // a probe through more groups than that takes the latch instead
+  static constexpr size_t MAX_PROBE_GROUPS = 8;
+
+  // a group's sequence counter, odd while a writer changes its slots
+  struct Version {
+    std::atomic<size_t> value;
+    char padding[64 - sizeof(std::atomic<size_t>)]; // a cache line each
+  };
+
+  // home slot of key (fibonacci hashing)
+  size_t HashKey(page_id_t key) const;
+  // Find under the latch, for a probe too long to validate
+  bool FindLocked(const page_id_t &key, V &value);
+  // start/end a change of the slots first_slot .. last_slot (cyclic), caller
+  // holds latch_
+  void BeginWrite(size_t first_slot, size_t last_slot);
+  void EndWrite(size_t first_slot, size_t last_slot);
+
+  size_t max_size_;
+  size_t shift_; // 64 - log2(capacity)
+  size_t mask_;  // capacity - 1
+  size_t size_;
+  std::unique_ptr<std::atomic<page_id_t>[]> keys_; // INVALID_PAGE_ID: empty
+  std::unique_ptr<std::atomic<V>[]> values_;
+  std::unique_ptr<Version[]> versions_; // one per group of slots
+  std::mutex latch_;                    // serialize writers
+};
+
+} // namespace scudb
@@ -31,13 +31,17 @@ INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
 public:
   explicit BPlusTree(const std::string &name,
-                           BufferPoolManager *buffer_pool_manager,
+                           BufferPool *buffer_pool_manager,
                            const KeyComparator &comparator,
                            page_id_t root_page_id = INVALID_PAGE_ID);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
+  // give back the pages reserved for the tree but not used, while the
+  // buffer pool is still there
+  inline void ReleaseExtent() { extent_.Release(); }
+
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value,
               Transaction *transaction = nullptr);
@@ -56,6 +60,9 @@ public:
   // Print this B+ tree to stdout using a simple command-line
   std::string ToString(bool verbose = false);
 
+  // number of levels from the root to the leaves, 0 for an empty tree
+  int GetHeight();
+
   // read data from file and insert one by one
   void InsertFromFile(const std::string &file_name,
                       Transaction *transaction = nullptr);
@@ -70,12 +77,17 @@ private:
   void UnlockPage(Page* page, Transaction* txn, Operation op);
   void UnlockParentPage(Page* page, Transaction* txn, Operation op);
   void UnlockAllPage(Transaction* txn, Operation op);
+  // replacement hint for a latched node: the root and the internal pages are
+  // on the path of every lookup, the buffer pool keeps them over the leaves
+  PagePriority GetPriority(Page* page);
 
 
   Page *FindLeafPage(const KeyType &key,
                     bool leftMost = false, 
                     Transaction *txn = nullptr,
                     Operation op = Operation::SEARCH);
+  Page *FindLeafPageOptimistic(const KeyType &key, bool leftMost,
+                               Transaction *txn);
 
   void StartNewTree(const KeyType &key, const ValueType &value, Transaction* txn);
 
@@ -86,7 +98,7 @@ private:
                         BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
-  template <typename N> N *Split(N *node);
+  template <typename N> Page *Split(N *node);
 
   template <typename N>
   bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
@@ -109,9 +121,10 @@ private:
   // member variable
   std::string index_name_;
   page_id_t root_page_id_;
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPool *buffer_pool_manager_;
   KeyComparator comparator_;
   int split_count_;
+  Extent extent_; // new pages of the tree are taken from
 
   std::mutex root_mutex_; // mutex for root page id
   
@@ -20,7 +20,7 @@ class BPlusTreeIndex : public Index {
 
 public:
   BPlusTreeIndex(IndexMetadata *metadata,
-                 BufferPoolManager *buffer_pool_manager,
+                 BufferPool *buffer_pool_manager,
                  page_id_t root_page_id = INVALID_PAGE_ID);
 
   ~BPlusTreeIndex() {}
@@ -34,6 +34,8 @@ public:
   void ScanKey(const Tuple &key, std::vector<RID> &result,
                Transaction *transaction = nullptr) override;
 
+  void ReleaseExtent() override { container_.ReleaseExtent(); }
+
 protected:
   // comparator for key
   KeyComparator comparator_;
@@ -133,6 +133,9 @@ public:
   virtual void ScanKey(const Tuple &key, std::vector<RID> &result,
                        Transaction *transaction = nullptr) = 0;
 
+  // give back the pages reserved for the index but not used, if it keeps any
+  virtual void ReleaseExtent() {}
+
 private:
   //===--------------------------------------------------------------------===//
   //  Data members
@@ -14,7 +14,7 @@ INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
 public:
   // you may define your own constructor based on your member variables
-  IndexIterator(page_id_t page_id, int index, BufferPoolManager* manager);
+  IndexIterator(page_id_t page_id, int index, BufferPool* manager);
   ~IndexIterator();
 
   bool isEnd();
@@ -27,7 +27,7 @@ private:
   // add your own private member variables here
   page_id_t page_id_;
   int index_;
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPool *buffer_pool_manager_;
   B_PLUS_TREE_LEAF_PAGE_TYPE * leaf_;
 };
 
@@ -10,6 +10,7 @@
 #include <condition_variable>
 #include <future>
 #include <mutex>
+#include <thread>
 
 #include "disk/disk_manager.h"
 #include "logging/log_record.h"
@@ -18,15 +19,20 @@ namespace scudb {
 
 class LogManager {
 public:
-  LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN),
-        disk_manager_(disk_manager) {
+  // the log buffer is sized for a buffer pool of pool_size frames
+  LogManager(DiskManager *disk_manager, size_t pool_size = BUFFER_POOL_SIZE)
+      : next_lsn_(0), persistent_lsn_(INVALID_LSN), offset_(0),
+        flush_thread_(nullptr), flush_running_(false), flush_requested_(false),
+        flushing_(false), disk_manager_(disk_manager) {
     // TODO: you may intialize your own defined memeber variables here
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_buffer_size_ =
+        LOG_BUFFER_SIZE(pool_size, disk_manager->GetPageSize());
+    log_buffer_ = new char[log_buffer_size_];
+    flush_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -39,30 +45,52 @@ public:
   // append a log record into log buffer
   lsn_t AppendLogRecord(LogRecord &log_record);
 
+  // wake the flush thread and wait until the log is on disk up to lsn;
+  // returns at once if there is no flush thread to wait for, or no record
+  // has been given lsn yet
+  void ForceFlush(lsn_t lsn);
+
+  // the record of lsn is not on disk yet; false for an lsn no record has
+  // been given, e.g. the 0 of a fresh page
+  inline bool NeedsFlush(lsn_t lsn) {
+    return lsn > persistent_lsn_ && lsn < next_lsn_;
+  }
+
   // get/set helper functions
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
+  inline size_t GetLogBufferSize() { return log_buffer_size_; }
 
 private:
-  // TODO: you may add your own member variables
-  // also remember to change constructor accordingly
-
   // atomic counter, record the next log sequence number
   std::atomic<lsn_t> next_lsn_;
   // log records before & include persistent_lsn_ have been written to disk
   std::atomic<lsn_t> persistent_lsn_;
-  // log buffer related
+  // log buffer related, sized by the page size of the database
+  size_t log_buffer_size_;
   char *log_buffer_;
   char *flush_buffer_;
+  // bytes of log_buffer_ in use, guarded by latch_
+  size_t offset_;
   // latch to protect shared member variables
   std::mutex latch_;
   // flush thread
   std::thread *flush_thread_;
+  // set while the flush thread runs, guarded by latch_
+  bool flush_running_;
+  // someone waits for a flush (or for room in the log buffer), and a flush
+  // is writing flush_buffer_; guarded by latch_
+  bool flush_requested_;
+  bool flushing_;
   // for notifying flush thread
   std::condition_variable cv_;
   // disk manager
   DiskManager *disk_manager_;
+
+  // write the log buffer out and advance the persistent LSN; latch_ is held
+  // through lck, and released during the write
+  void FlushLogBuffer(std::unique_lock<std::mutex> &lck);
 };
 
 } // namespace scudb
@@ -17,11 +17,12 @@ namespace scudb {
 class LogRecovery {
 public:
   LogRecovery(DiskManager *disk_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPool *buffer_pool_manager)
       : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager),
         offset_(0) {
     // global transaction through recovery phase
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_buffer_ = new char[LOG_BUFFER_SIZE(
+        buffer_pool_manager->GetPoolSize(), disk_manager->GetPageSize())];
   }
 
   ~LogRecovery() {
@@ -37,7 +38,7 @@ private:
   // TODO: you can add whatever member variable here
   // Don't forget to initialize newly added variable in constructor
   DiskManager *disk_manager_;
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPool *buffer_pool_manager_;
   // maintain active transactions and its corresponds latest lsn
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   // mapping log sequence number to log file offset, for undo purpose
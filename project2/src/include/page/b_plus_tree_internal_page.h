@@ -29,7 +29,8 @@ INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
 public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID,
+            size_t page_size = PAGE_SIZE);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
@@ -39,6 +40,9 @@ public:
 //   void SetValueAt(int index, const ValueType &value);
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  // Lookup for a reader without the latch, bounded by the size it read
+  int LookupUnlatched(const KeyType &key, int size, bool left_most,
+                      ValueType &child, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                        const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
@@ -47,28 +51,28 @@ public:
   ValueType RemoveAndReturnOnlyChild();
 
   void MoveHalfTo(BPlusTreeInternalPage *recipient,
-                  BufferPoolManager *buffer_pool_manager);
+                  BufferPool *buffer_pool_manager);
   void MoveAllTo(BPlusTreeInternalPage *recipient, int index_in_parent,
-                 BufferPoolManager *buffer_pool_manager);
+                 BufferPool *buffer_pool_manager);
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient,
-                        BufferPoolManager *buffer_pool_manager);
+                        BufferPool *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient,
                          int parent_index,
-                         BufferPoolManager *buffer_pool_manager);
+                         BufferPool *buffer_pool_manager);
   // DEUBG and PRINT
   std::string ToString(bool verbose) const;
   void QueueUpChildren(std::queue<BPlusTreePage *> *queue,
-                       BufferPoolManager *buffer_pool_manager);
+                       BufferPool *buffer_pool_manager);
 
 private:
   void CopyHalfFrom(MappingType *items, int size,
-                    BufferPoolManager *buffer_pool_manager);
+                    BufferPool *buffer_pool_manager);
   void CopyAllFrom(MappingType *items, int size,
-                   BufferPoolManager *buffer_pool_manager);
+                   BufferPool *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair,
-                    BufferPoolManager *buffer_pool_manager);
+                    BufferPool *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, int parent_index,
-                     BufferPoolManager *buffer_pool_manager);
+                     BufferPool *buffer_pool_manager);
   MappingType array[0];
 };
 } // namespace scudb
@@ -5,10 +5,16 @@
  * our case, we will contain information about table/index name (length less than
  * 32 bytes) and their corresponding root_id
  *
+ * The page also records the page size of the database and its format flags
+ * (DB_FORMAT_SPACE_MAPS), which the disk manager reads back when the database
+ * is opened again.
+ *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ * | Magic (4) | PageSize (4) | Flags (4) | RecordCount (4) | Entry_1 name (32) |
+ *  ---------------------------------------------------------------------------
+ * | Entry_1 root_id (4) | ... |
+ *  ----------------------------
  */
 
 #pragma once
@@ -21,7 +27,7 @@ namespace scudb {
 
 class HeaderPage : public Page {
 public:
-  void Init() { SetRecordCount(0); }
+  void Init();
   /**
    * Record related
    */
@@ -38,6 +44,8 @@ private:
    * helper functions
    */
   int FindRecord(const std::string &name);
+  // offset of the index-th record
+  inline int RecordOffset(int index) { return 16 + index * 36; }
 
   void SetRecordCount(int record_count);
 };
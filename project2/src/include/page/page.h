@@ -8,44 +8,167 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwmutex.h"
 
 namespace scudb {
 
+/**
+ * Metadata of all the frames of a buffer pool, one dense array per field.
+ * Scans over every frame (background writer, counters) read only these arrays
+ * instead of striding over pages, and pages stay free of hot atomics.
+ * Metadata is atomic: the buffer pool pins and unpins without its latch.
+ */
+struct FrameTable {
+  explicit FrameTable(size_t num_frames)
+      : num_frames_(num_frames), num_child_tables_(0),
+        page_ids_(new std::atomic<page_id_t>[num_frames]()),
+        pin_counts_(new std::atomic<int>[num_frames]()),
+        is_dirty_(new std::atomic<bool>[num_frames]()),
+        io_in_progress_(new std::atomic<bool>[num_frames]()),
+        hit_counts_(new std::atomic<size_t>[num_frames]()),
+        load_hit_counts_(new size_t[num_frames]()),
+        child_frames_(new std::atomic<std::atomic<int> *>[num_frames]()),
+        swizzled_from_(new std::atomic<int64_t>[num_frames]()),
+        swizzle_hits_(new std::atomic<size_t>[num_frames]()),
+        partition_ids_(new std::atomic<uint8_t>[num_frames]()),
+        priorities_(new std::atomic<uint8_t>[num_frames]()) {}
+
+  ~FrameTable() {
+    for (size_t i = 0; i < num_frames_; ++i)
+      delete[] child_frames_[i].load();
+  }
+
+  // memory taken by the metadata of one frame, swizzle tables aside
+  static constexpr size_t BytesPerFrame() {
+    return sizeof(std::atomic<page_id_t>) + sizeof(std::atomic<int>) +
+           2 * sizeof(std::atomic<bool>) + 3 * sizeof(std::atomic<size_t>) +
+           sizeof(std::atomic<std::atomic<int> *>) +
+           sizeof(std::atomic<int64_t>) + 2 * sizeof(std::atomic<uint8_t>);
+  }
+
+  // the swizzle table of frame, num_slots entries of -1 made on first use.
+  // It stays with the frame until the table goes: an optimistic reader may
+  // still follow it after the frame got another page
+  inline std::atomic<int> *GetChildFrames(size_t frame_id, size_t num_slots) {
+    std::atomic<int> *table = child_frames_[frame_id];
+    if (table != nullptr)
+      return table;
+    std::atomic<int> *new_table = new std::atomic<int>[num_slots];
+    for (size_t i = 0; i < num_slots; ++i)
+      new_table[i] = -1;
+    if (!child_frames_[frame_id].compare_exchange_strong(table, new_table)) {
+      delete[] new_table;
+      return table;
+    }
+    num_child_tables_++;
+    return new_table;
+  }
+
+  size_t num_frames_;
+  // swizzle tables made so far
+  std::atomic<size_t> num_child_tables_;
+
+  std::unique_ptr<std::atomic<page_id_t>[]> page_ids_;
+  // -1 while the frame holds no page (free, being evicted or deleted)
+  std::unique_ptr<std::atomic<int>[]> pin_counts_;
+  std::unique_ptr<std::atomic<bool>[]> is_dirty_;
+  // the page is being read from / written to disk
+  std::unique_ptr<std::atomic<bool>[]> io_in_progress_;
+  // FetchPage hits served by the frame, summed up by the buffer pool
+  std::unique_ptr<std::atomic<size_t>[]> hit_counts_;
+  // hit_counts_ when the frame got its page, the difference is the page's
+  // temperature; written under the buffer pool latch
+  std::unique_ptr<size_t[]> load_hit_counts_;
+  // child references of an internal page swizzled to frames: per frame a
+  // table made when the frame first holds a swizzled parent (nullptr before),
+  // entry i holds the frame of child i or -1
+  std::unique_ptr<std::atomic<std::atomic<int> *>[]> child_frames_;
+  // the entry swizzled to this frame, parent frame << 32 | slot, -1 if none
+  std::unique_ptr<std::atomic<int64_t>[]> swizzled_from_;
+  // optimistic child fetches served by a swizzled reference
+  std::unique_ptr<std::atomic<size_t>[]> swizzle_hits_;
+  // partition of the buffer pool whose page the frame holds (or last held),
+  // changed under the buffer pool latch while the frame is claimed
+  std::unique_ptr<std::atomic<uint8_t>[]> partition_ids_;
+  // replacement priority of the page, set by hints of the pinning threads
+  std::unique_ptr<std::atomic<uint8_t>[]> priorities_;
+};
+
 class Page {
   friend class BufferPoolManager;
 
 public:
-  Page() { ResetMemory(); }
+  // the frame_id-th frame of a buffer pool, data points into its arena
+  Page(FrameTable &frames, size_t frame_id, char *data, size_t page_size)
+      : data_(data), page_size_(page_size), frame_id_(frame_id),
+        page_id_(frames.page_ids_[frame_id]),
+        pin_count_(frames.pin_counts_[frame_id]),
+        is_dirty_(frames.is_dirty_[frame_id]),
+        io_in_progress_(frames.io_in_progress_[frame_id]),
+        hit_count_(frames.hit_counts_[frame_id]) {}
   ~Page(){};
   // get actual data page content
   inline char *GetData() { return data_; }
+  // size of the page content, the page size of its database
+  inline size_t GetPageSize() { return page_size_; }
   // get page id
   inline page_id_t GetPageId() { return page_id_; }
   // get page pin count
   inline int GetPinCount() { return pin_count_; }
+  // get the slot of this frame inside its buffer pool
+  inline size_t GetFrameId() { return frame_id_; }
   // method use to latch/unlatch page content
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WUnlatch() {
+    EndWrite();
+    rwlatch_.WUnlock();
+  }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    BeginWrite();
+  }
   inline void RUnlatch() { rwlatch_.RUnlock(); }
   inline void RLatch() { rwlatch_.RLock(); }
+  // optimistic read without the latch: take the version (odd while a writer
+  // is at work), read, then the read is good if the version is unchanged
+  inline uint64_t GetVersion() {
+    return version_.load(std::memory_order_acquire);
+  }
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
 
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
 
 private:
   // method used by buffer pool manager
-  inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, 0, page_size_); }
+  // bracket every change of the content, WLatch or disk read
+  inline void BeginWrite() {
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  inline void EndWrite() { version_.fetch_add(1, std::memory_order_release); }
   // members
-  char data_[PAGE_SIZE]; // actual data
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  int pin_count_ = 0;
-  bool is_dirty_ = false;
+  char *data_; // actual data, in the arena of the buffer pool
+  size_t page_size_;
+  size_t frame_id_;
+  // this frame's entries of the buffer pool's FrameTable
+  std::atomic<page_id_t> &page_id_;
+  std::atomic<int> &pin_count_;
+  std::atomic<bool> &is_dirty_;
+  std::atomic<bool> &io_in_progress_;
+  std::atomic<size_t> &hit_count_;
   RWMutex rwlatch_;
+  // seqlock word of the content, next to the latch writers take anyway
+  std::atomic<uint64_t> version_{0};
 };
 
 } // namespace scudb
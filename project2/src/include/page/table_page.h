@@ -64,6 +64,10 @@ public:
   // return tuple (with data pointing to heap) if success
   bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
                 LockManager *lock_manager);
+  // GetTuple without the latch, on a page read at version (see
+  // Page::GetVersion); false if it has to be retried through GetTuple
+  bool GetTupleOptimistic(const RID &rid, Tuple &tuple, uint64_t version,
+                          bool &found);
 
   /**
    * Tuple iterator
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "buffer/buffer_pool_manager.h"
 #include "logging/log_manager.h"
 #include "page/table_page.h"
@@ -21,11 +23,11 @@ public:
   ~TableHeap() {}
 
   // open a table heap
-  TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
+  TableHeap(BufferPool *buffer_pool_manager, LockManager *lock_manager,
             LogManager *log_manager, page_id_t first_page_id);
 
   // create table heap
-  TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
+  TableHeap(BufferPool *buffer_pool_manager, LockManager *lock_manager,
             LogManager *log_manager, Transaction *txn);
 
   // for insert, if tuple is too large (>~page_size), return false
@@ -46,20 +48,39 @@ public:
 
   bool DeleteTableHeap();
 
-  TableIterator begin(Transaction *txn);
+  // use_ring: read the pages through a small strategy ring, so that a large
+  // scan does not evict the pages other queries are working on. Without it a
+  // scan switches to a ring once it walked more than 1/SCAN_RING_THRESHOLD
+  // of the pool
+  TableIterator begin(Transaction *txn, bool use_ring = false);
 
   TableIterator end();
 
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  // the buffer pool (or partition of one) holding the table's pages
+  inline BufferPool *GetBufferPoolManager() const {
+    return buffer_pool_manager_;
+  }
+
+  // pages counted by the last full scan plus pages appended since, 0 for a
+  // reopened table that has not been scanned yet
+  inline size_t GetNumPages() const { return num_pages_; }
+
+  // give back the pages reserved for the table but not used, while the
+  // buffer pool is still there
+  inline void ReleaseExtent() { extent_.Release(); }
+
 private:
   /**
    * Members
    */
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPool *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_;
+  std::atomic<size_t> num_pages_;
+  Extent extent_; // new pages of the table are taken from
 };
 
 } // namespace scudb
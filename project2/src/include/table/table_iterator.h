@@ -7,7 +7,9 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 
+#include "buffer/buffer_ring.h"
 #include "common/rid.h"
 #include "table/tuple.h"
 
@@ -19,7 +21,13 @@ class TableIterator {
   friend class Cursor;
 
 public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  // a scan given a ring reads its pages through it (see buffer_ring.h)
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                std::shared_ptr<BufferRing> ring = nullptr);
+
+  TableIterator(const TableIterator &other);
+
+  TableIterator &operator=(const TableIterator &other);
 
   ~TableIterator() { delete tuple_; }
 
@@ -40,9 +48,14 @@ public:
   TableIterator operator++(int);
 
 private:
+  // fetch a page of the heap, through the ring if the scan has one
+  Page *FetchPage(page_id_t page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  std::shared_ptr<BufferRing> ring_; // shared by copies of the iterator
+  size_t num_pages_;                 // pages of the heap walked so far
 };
 
 } // namespace scudb
\ No newline at end of file
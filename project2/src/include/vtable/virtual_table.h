@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include "buffer/buffer_pool_partition.h"
 #include "buffer/lru_replacer.h"
 #include "catalog/schema.h"
+#include "common/logger.h"
 #include "concurrency/transaction_manager.h"
 #include "index/b_plus_tree_index.h"
 #include "logging/log_manager.h"
@@ -22,10 +24,17 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
                                    const std::string &table_name,
                                    Schema *schema);
 
+// "name:min_frames[:max_frames]", the partition of buffer_pool_manager by
+// that name, created with those shares the first time; nullptr with error
+// set if the statement is malformed or the partition cannot be made
+BufferPool *ParsePoolStatement(const std::string &sql,
+                               BufferPoolManager *buffer_pool_manager,
+                               std::string &error);
+
 Tuple ConstructTuple(Schema *schema, sqlite3_value **argv);
 
 Index *ConstructIndex(IndexMetadata *metadata,
-                      BufferPoolManager *buffer_pool_manager,
+                      BufferPool *buffer_pool_manager,
                       page_id_t root_id = INVALID_PAGE_ID);
 Transaction *GetTransaction();
 
@@ -62,17 +71,41 @@ int VtabBegin(sqlite3_vtab *pVTab);
 // storage engine
 class StorageEngine {
 public:
-  StorageEngine(std::string db_file_name) {
+  // pool_size frames, the pool can be resized up to max_pool_size; page_size
+  // is only used when the database is created; compressed_cache_size bytes
+  // for a compressed tier under the pool, 0 for none
+  StorageEngine(std::string db_file_name, size_t pool_size = BUFFER_POOL_SIZE,
+                size_t page_size = PAGE_SIZE, size_t max_pool_size = 0,
+                size_t compressed_cache_size = 0,
+                size_t shared_cache_size = 0) {
     ENABLE_LOGGING = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = new DiskManager(db_file_name, page_size);
+    if (disk_manager_->IsOlderFormat()) {
+      delete disk_manager_;
+      throw Exception(EXCEPTION_TYPE_MISMATCH_TYPE,
+                      db_file_name +
+                          " was created by an older version of the database "
+                          "and cannot be opened");
+    }
 
     // log related
-    log_manager_ = new LogManager(disk_manager_);
+    log_manager_ = new LogManager(disk_manager_, pool_size);
 
     buffer_pool_manager_ =
-        new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+        new BufferPoolManager(pool_size, disk_manager_, log_manager_,
+                              ReplacerType::LRU, max_pool_size);
+    buffer_pool_manager_->EnableCompressedCache(compressed_cache_size);
+    // other processes of the database share their pages through it
+    buffer_pool_manager_->EnableSharedCache(
+        SharedPageCache::GetSegmentName(db_file_name), shared_cache_size);
+    // start with the pages that were hot before the last shutdown, and keep
+    // the image up to date for the next start
+    std::string warm_image_file = db_file_name + ".warm";
+    buffer_pool_manager_->WarmUp(warm_image_file);
+    buffer_pool_manager_->SetWarmImageFile(warm_image_file);
+    buffer_pool_manager_->RunWriterThread();
 
     // txn related
     lock_manager_ = new LockManager(true); // S2PL
@@ -80,10 +113,19 @@ public:
   }
 
   ~StorageEngine() {
+    for (auto partition : buffer_pool_manager_->GetPartitions()) {
+      LOG_INFO("buffer pool partition %s: %zu frames, hit ratio %.3f",
+               partition->GetName().c_str(), partition->GetNumFrames(),
+               partition->GetHitRatio());
+    }
+    // the writer and the read-ahead thread still use the disk and log
+    // managers
+    buffer_pool_manager_->StopWriterThread();
+    buffer_pool_manager_->StopPrefetchThread();
     if (ENABLE_LOGGING)
       log_manager_->StopFlushThread();
-    delete disk_manager_;
     delete buffer_pool_manager_;
+    delete disk_manager_;
     delete log_manager_;
     delete lock_manager_;
     delete transaction_manager_;
@@ -104,7 +146,7 @@ class VirtualTable {
   friend class Cursor;
 
 public:
-  VirtualTable(Schema *schema, BufferPoolManager *buffer_pool_manager,
+  VirtualTable(Schema *schema, BufferPool *buffer_pool_manager,
                LockManager *lock_manager, LogManager *log_manager, Index *index,
                page_id_t first_page_id = INVALID_PAGE_ID)
       : schema_(schema), index_(index) {
@@ -122,6 +164,9 @@ public:
   }
 
   ~VirtualTable() {
+    table_heap_->ReleaseExtent();
+    if (index_ != nullptr)
+      index_->ReleaseExtent();
     delete schema_;
     delete table_heap_;
     delete index_;
@@ -172,7 +217,9 @@ public:
     return table_heap_->UpdateTuple(tuple, rid, GetTransaction());
   }
 
-  inline TableIterator begin() { return table_heap_->begin(GetTransaction()); }
+  inline TableIterator begin(bool use_ring = false) {
+    return table_heap_->begin(GetTransaction(), use_ring);
+  }
 
   inline TableIterator end() { return table_heap_->end(); }
 
@@ -206,6 +253,19 @@ public:
 
   inline bool IsIndexScan() { return is_index_scan_; }
 
+  // rewind the sequential scan. A table larger than 1/SCAN_RING_THRESHOLD of
+  // the buffer pool is read through a ring, so that scanning it does not
+  // evict everything else; one whose size is not known yet switches to the
+  // ring once the scan has walked that many pages
+  inline void BeginSeqScan() {
+    size_t pool_size =
+        virtual_table_->table_heap_->GetBufferPoolManager()->GetPoolSize();
+    bool use_ring = virtual_table_->table_heap_->GetNumPages() >
+                    pool_size / SCAN_RING_THRESHOLD;
+    is_index_scan_ = false;
+    table_iterator_ = virtual_table_->begin(use_ring);
+  }
+
   inline VirtualTable *GetVirtualTable() { return virtual_table_; }
 
   inline Schema *GetKeySchema() {
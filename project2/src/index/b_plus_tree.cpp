@@ -3,6 +3,7 @@
  */
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -14,7 +15,7 @@ namespace scudb {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(const std::string &name,
-                                BufferPoolManager *buffer_pool_manager,
+                                BufferPool *buffer_pool_manager,
                                 const KeyComparator &comparator,
                                 page_id_t root_page_id)
     : index_name_(name), root_page_id_(root_page_id),
@@ -84,14 +85,14 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value, Transaction* txn) {
 
     assert(IsEmpty());
-    auto page = buffer_pool_manager_->NewPage(root_page_id_);
+    auto page = buffer_pool_manager_->NewPage(root_page_id_, &extent_);
     if(page == nullptr){
         throw Exception(EXCEPTION_TYPE_INDEX, "Out of memory");
     }
     LockPage(page, txn, Operation::INSERT);
     auto root = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
     UpdateRootPageId(true);
-    root->Init(root_page_id_, INVALID_PAGE_ID);
+    root->Init(root_page_id_, INVALID_PAGE_ID, page->GetPageSize());
     assert(!IsEmpty());
     root->Insert(key, value, comparator_);
     page->WUnlatch();
@@ -129,7 +130,8 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
             if(transaction != nullptr)
                 assert(transaction->GetPageSet()->empty());
         }else{
-            auto new_leaf_node = Split(leaf);
+            auto new_leaf_page = Split(leaf);
+            auto new_leaf_node = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(new_leaf_page->GetData());
             assert(new_leaf_node->IsLeafPage()); 
             new_leaf_node->SetNextPageId(leaf->GetNextPageId());
             leaf->SetNextPageId(new_leaf_node->GetPageId());
@@ -144,6 +146,8 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
             }else{
                 new_leaf_node->Insert(key, value, comparator_);
             }
+            new_leaf_page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(new_leaf_node->GetPageId(), true);
             
     
             // Insert finish
@@ -161,23 +165,26 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * Using template N to represent either internal page or leaf page.
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
- * of key & value pairs from input page to newly created page
+ * of key & value pairs from input page to newly created page.
+ * The new page is returned pinned and write latched, the caller releases it
+ * once it is filled and linked into its parent
  */
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N> N *BPLUSTREE_TYPE::Split(N *node) {
+template <typename N> Page *BPLUSTREE_TYPE::Split(N *node) {
     page_id_t new_page_id;
-    auto new_page = buffer_pool_manager_->NewPage(new_page_id);
+    auto new_page = buffer_pool_manager_->NewPage(new_page_id, &extent_);
     if(new_page == nullptr){
         throw Exception(EXCEPTION_TYPE_INDEX, "Split: Out of memory");
     }
+    new_page->WLatch();
     
     N* new_node = reinterpret_cast<N *>(new_page->GetData());
-    new_node->Init(new_page_id, INVALID_PAGE_ID);
+    new_node->Init(new_page_id, INVALID_PAGE_ID, new_page->GetPageSize());
     node->MoveHalfTo(new_node, buffer_pool_manager_);
     split_count_ ++;
 
     assert(new_page->GetPinCount() == 1 && new_page->GetPageId() == new_node->GetPageId()); 
-    return new_node;
+    return new_page;
 }
 
 /*
@@ -197,7 +204,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
     //
     if(old_node->IsRootPage()){
         //If the old node is the root node
-        auto page = buffer_pool_manager_->NewPage(root_page_id_);
+        auto page = buffer_pool_manager_->NewPage(root_page_id_, &extent_);
         if(page == nullptr){
             throw Exception(EXCEPTION_TYPE_INDEX, "InsertIntoParent: Out of memory");
         }
@@ -206,7 +213,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
         auto new_root = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
                                                KeyComparator> *>(page->GetData());
         // generate new root
-        new_root->Init(root_page_id_, INVALID_PAGE_ID);
+        new_root->Init(root_page_id_, INVALID_PAGE_ID, page->GetPageSize());
         assert(new_root->GetPageId() == root_page_id_);
         new_root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
         // Update the children page 
@@ -228,7 +235,8 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
 
         }else{
             //Parent page is full, split parent page 
-            auto new_internal = Split(parent);
+            auto new_internal_page = Split(parent);
+            auto new_internal = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(new_internal_page->GetData());
             new_internal->SetParentPageId(parent->GetParentPageId());
             KeyType mid_one = new_internal->KeyAt(0);
             if(comparator_(key, mid_one) < 0){
@@ -239,10 +247,11 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
                 new_node->SetParentPageId(new_internal->GetPageId());
             }
             InsertIntoParent(parent, mid_one, new_internal, transaction);
+            new_internal_page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(new_internal->GetPageId(), true);
         }
         buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
     }
-    buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
 }
 
 /*****************************************************************************
@@ -288,10 +297,15 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
         UnlockParentPage(leaf_page, transaction, Operation::DELETE);
         UnlockPage(leaf_page, transaction, Operation::DELETE);
     }
+    // an optimistic lookup may hold a deleted page pinned for a moment,
+    // until its version check sends it back up the tree
     for(auto it = transaction->GetDeletedPageSet()->begin();
      it != transaction->GetDeletedPageSet()->end(); ++it){
-        assert(buffer_pool_manager_->DeletePage(*it));
+        while(!buffer_pool_manager_->DeletePage(*it)){
+            std::this_thread::yield();
+        }
     }
+    transaction->GetDeletedPageSet()->clear();
 }
 
 
@@ -300,6 +314,9 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * The parent is write latched already (node was not safe), the sibling is
+ * write latched here while it changes, so that optimistic readers see its
+ * version move.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
@@ -327,30 +344,36 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
             // The left most node 
             auto neighbor_page = buffer_pool_manager_->FetchPage(parent->ValueAt(index_in_parent+1));
             assert(neighbor_page != nullptr);
+            neighbor_page->WLatch();
             N* neighbor_node = reinterpret_cast<N *>(neighbor_page->GetData());
             if(node->GetSize() + neighbor_node->GetSize() <= node->GetMaxSize()){
                 Coalesce(node, neighbor_node, parent, index_in_parent+1, transaction);
                 buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-                buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
+                neighbor_page->WUnlatch();
+                buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
                 return false;
             }else{
                 Redistribute(neighbor_node, node, index_in_parent);
                 buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+                neighbor_page->WUnlatch();
                 buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
                 return false;
             }
         }else{
             auto neighbor_page = buffer_pool_manager_->FetchPage(parent->ValueAt(index_in_parent-1));
             assert(neighbor_page != nullptr);
+            neighbor_page->WLatch();
             N* neighbor_node = reinterpret_cast<N *>(neighbor_page->GetData());
             if(node->GetSize() + neighbor_node->GetSize() <= node->GetMaxSize()){
                 Coalesce(neighbor_node, node, parent, index_in_parent, transaction);
                 buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-                buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
+                neighbor_page->WUnlatch();
+                buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
                 return true;
             }else{
                 Redistribute(neighbor_node, node, index_in_parent);
                 buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+                neighbor_page->WUnlatch();
                 buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
                 return false;
             }
@@ -428,6 +451,8 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
             auto root_node = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(old_root_node);
             root_page_id_ = root_node->ValueAt(0);
             UpdateRootPageId(false);
+            // the only child left is the node or the sibling the coalesce
+            // came from, both write latched by this thread
             auto page = buffer_pool_manager_->FetchPage(root_page_id_);
             auto new_root = reinterpret_cast<BPlusTreePage *>(page->GetData());
             new_root->SetParentPageId(INVALID_PAGE_ID);
@@ -500,17 +525,25 @@ void BPLUSTREE_TYPE::LockPage(Page* page, Transaction* txn, Operation op){
         txn->GetPageSet()->push_back(page);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+PagePriority BPLUSTREE_TYPE::GetPriority(Page* page){
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if(node->IsRootPage()) return PagePriority::ROOT;
+    return node->IsLeafPage() ? PagePriority::LOW : PagePriority::INTERNAL;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UnlockPage(Page* page, Transaction* txn, Operation op){
     if(page->GetPageId() == root_page_id_){
         UnlockRoot();
     }
+    auto priority = GetPriority(page);
     if(op == Operation::SEARCH){
         page->RUnlatch();
-        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false, priority);
     }else{
         page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true, priority);
     }
     if(txn != nullptr)
         txn->GetPageSet()->pop_front();
@@ -525,15 +558,16 @@ void BPLUSTREE_TYPE::UnlockAllPage(Transaction* txn, Operation op){
     while(!txn->GetPageSet()->empty()){
         auto front = txn->GetPageSet()->front();
         if(front->GetPageId() != INVALID_PAGE_ID){
+            auto priority = GetPriority(front);
             if(op == Operation::SEARCH){
                 front->RUnlatch();
-                buffer_pool_manager_->UnpinPage(front->GetPageId(), false);
+                buffer_pool_manager_->UnpinPage(front->GetPageId(), false, priority);
             }else{
                 if(front->GetPageId() == root_page_id_){
                     UnlockRoot();
                 }
                 front->WUnlatch(); 
-                buffer_pool_manager_->UnpinPage(front->GetPageId(), true);
+                buffer_pool_manager_->UnpinPage(front->GetPageId(), true, priority);
             }
         }
         txn->GetPageSet()->pop_front();
@@ -555,15 +589,16 @@ void BPLUSTREE_TYPE::UnlockParentPage(Page* page, Transaction* txn, Operation op
         while(!txn->GetPageSet()->empty() && txn->GetPageSet()->front()->GetPageId() != page->GetPageId()){
             auto front = txn->GetPageSet()->front();
             if(front->GetPageId() != INVALID_PAGE_ID){
+                auto priority = GetPriority(front);
                 if(op == Operation::SEARCH){
                     front->RUnlatch();
-                    buffer_pool_manager_->UnpinPage(front->GetPageId(), false);
+                    buffer_pool_manager_->UnpinPage(front->GetPageId(), false, priority);
                 }else{
                     if(front->GetPageId() == root_page_id_){
                         UnlockRoot();
                     }
                     front->WUnlatch(); 
-                    buffer_pool_manager_->UnpinPage(front->GetPageId(), true);
+                    buffer_pool_manager_->UnpinPage(front->GetPageId(), true, priority);
                 }
             }
             txn->GetPageSet()->pop_front();
@@ -577,7 +612,10 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,bool leftMost,
     // Check empty
     if(IsEmpty()) return nullptr;  
    
-    if(op != Operation::SEARCH){
+    if(op == Operation::SEARCH){
+        auto leaf_page = FindLeafPageOptimistic(key, leftMost, txn);
+        if(leaf_page != nullptr) return leaf_page;
+    }else{
         // All write latch will lock
         LockRoot();
     }
@@ -598,8 +636,9 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,bool leftMost,
             child_page_id = internal->Lookup(key, comparator_);
         }
         if(txn==nullptr) {
+            auto priority = GetPriority(page);
             page->RUnlatch();
-            buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+            buffer_pool_manager_->UnpinPage(page->GetPageId(), false, priority);
         }
         page = buffer_pool_manager_->FetchPage(child_page_id);
         if(page == nullptr){
@@ -621,11 +660,74 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,bool leftMost,
     return page;
 }
 
+/*
+ Search descent without latching internal pages: each one is read at a
+ version and validated once the child id is taken, only the leaf is pinned
+ and read latched. Child references are followed through the buffer pool's
+ swizzled frames, a hot descent does not touch the page table. Returns nullptr after OPTIMISTIC_READ_RETRIES conflicts
+ with writers or on a page not in the pool, FindLeafPage then latches.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool leftMost,
+                                             Transaction *txn) {
+    typedef BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> InternalPage;
+    for(int retry = 0; retry < OPTIMISTIC_READ_RETRIES; retry++){
+        page_id_t page_id = root_page_id_;
+        if(page_id == INVALID_PAGE_ID) return nullptr;
+        uint64_t version;
+        auto page = buffer_pool_manager_->FetchPageOptimistic(page_id, version);
+        if(page == nullptr) return nullptr;
+        auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+        // the root may have split since root_page_id_ was read
+        bool valid = (version & 1) == 0 && node->IsRootPage();
+        while(valid && !node->IsLeafPage()){
+            // the page may be torn, keep every read inside it
+            auto internal = reinterpret_cast<InternalPage *>(node);
+            int size = internal->GetSize();
+            int capacity = (page->GetPageSize() - sizeof(InternalPage)) /
+                           (sizeof(KeyType) + sizeof(page_id_t));
+            if(size < 1 || size > capacity){
+                valid = false;
+                break;
+            }
+            page_id_t child_page_id;
+            int index = internal->LookupUnlatched(key, size, leftMost,
+                                                  child_page_id, comparator_);
+            uint64_t child_version;
+            auto child = buffer_pool_manager_->FetchChildOptimistic(
+                page, index, child_page_id, child_version);
+            // the child id is good only if the parent did not change meanwhile
+            if(!page->ValidateVersion(version)){
+                valid = false;
+                break;
+            }
+            if(child == nullptr) return nullptr;
+            page = child;
+            page_id = child_page_id;
+            version = child_version;
+            node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+            valid = (version & 1) == 0;
+        }
+        if(!valid) continue;
+
+        // it is the right leaf if it did not change since the parent was valid
+        auto leaf_page = buffer_pool_manager_->FetchFrame(page, page_id);
+        if(leaf_page == nullptr) return nullptr;
+        leaf_page->RLatch();
+        if(leaf_page == page && leaf_page->ValidateVersion(version)){
+            if(txn != nullptr) txn->GetPageSet()->push_back(leaf_page);
+            return leaf_page;
+        }
+        leaf_page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    return nullptr;
+}
   
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(
-      buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+      buffer_pool_manager_->FetchPage(HEADER_PAGE_ID, PagePriority::ROOT));
   if (insert_record)
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -642,6 +744,34 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
 INDEX_TEMPLATE_ARGUMENTS
 std::string BPLUSTREE_TYPE::ToString(bool verbose) { return "Empty tree"; }
 
+/*
+ * Follow the leftmost children down to a leaf, counting the levels
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::GetHeight() {
+    int height = 0;
+    page_id_t page_id = root_page_id_;
+    while(page_id != INVALID_PAGE_ID){
+        auto page = buffer_pool_manager_->FetchPage(page_id);
+        if(page == nullptr){
+            throw Exception(EXCEPTION_TYPE_INDEX, "GetHeight: cannot get page");
+        }
+        page->RLatch();
+        auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+        if(node->IsLeafPage()){
+            page_id = INVALID_PAGE_ID;
+        }else{
+            page_id = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
+                                         KeyComparator> *>(node)->ValueAt(0);
+        }
+        auto priority = GetPriority(page);
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false, priority);
+        height++;
+    }
+    return height;
+}
+
 /*
  * This method is used for test only
  * Read data from file and insert one by one
@@ -10,7 +10,7 @@ namespace scudb {
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata,
-                                     BufferPoolManager *buffer_pool_manager,
+                                     BufferPool *buffer_pool_manager,
                                      page_id_t root_page_id)
     : Index(metadata), comparator_(metadata->GetKeySchema()),
       container_(metadata->GetName(), buffer_pool_manager, comparator_,
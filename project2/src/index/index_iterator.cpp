@@ -12,7 +12,7 @@ namespace scudb {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(page_id_t page_id, int index, BufferPoolManager* manager) : 
+INDEXITERATOR_TYPE::IndexIterator(page_id_t page_id, int index, BufferPool* manager) : 
 page_id_(page_id), index_(index), buffer_pool_manager_(manager) {
     auto page = buffer_pool_manager_->FetchPage(page_id_);
     if(page == nullptr){
@@ -56,6 +56,11 @@ IndexIterator<KeyType, ValueType, KeyComparator> &INDEXITERATOR_TYPE::operator++
             leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
             index_ = 0;
             page_id_ = next;
+            // the scan walks the leaf chain, read the following leaves ahead
+            buffer_pool_manager_->ReadAhead(leaf_->GetNextPageId(), [](Page *page) {
+                return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(
+                    page->GetData())->GetNextPageId();
+            });
         }
     }
     return *this;
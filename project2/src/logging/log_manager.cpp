@@ -12,11 +12,66 @@ namespace scudb {
  * manager wants to force flush (it only happens when the flushed page has a
  * larger LSN than persistent LSN)
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> lck(latch_);
+  if (flush_thread_ != nullptr)
+    return;
+  ENABLE_LOGGING = true;
+  flush_running_ = true;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> flush_lck(latch_);
+    while (flush_running_) {
+      cv_.wait_for(flush_lck, LOG_TIMEOUT,
+                   [this] { return !flush_running_ || flush_requested_; });
+      FlushLogBuffer(flush_lck);
+    }
+    // what was appended before the stop
+    FlushLogBuffer(flush_lck);
+  });
+}
 /*
  * Stop and join the flush thread, set ENABLE_LOGGING = false
+ * Whoever waits in ForceFlush gives up
+ */
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::lock_guard<std::mutex> lck(latch_);
+    if (flush_thread_ == nullptr)
+      return;
+    ENABLE_LOGGING = false;
+    flush_running_ = false;
+    flush_thread = flush_thread_;
+    flush_thread_ = nullptr;
+  }
+  cv_.notify_all();
+  flush_thread->join();
+  delete flush_thread;
+}
+
+/*
+ * Swap the buffers, so that appending goes on while the full one is written.
+ * Everything appended before the swap is on disk afterwards. One flush at a
+ * time: the disk manager expects the buffers to alternate.
  */
-void LogManager::StopFlushThread() {}
+void LogManager::FlushLogBuffer(std::unique_lock<std::mutex> &lck) {
+  cv_.wait(lck, [this] { return !flushing_; });
+  flush_requested_ = false;
+  lsn_t lsn = next_lsn_ - 1;
+  size_t size = offset_;
+  if (size > 0) {
+    flushing_ = true;
+    std::swap(log_buffer_, flush_buffer_);
+    offset_ = 0;
+    lck.unlock();
+    disk_manager_->WriteLog(flush_buffer_, static_cast<int>(size));
+    lck.lock();
+    flushing_ = false;
+  }
+  if (lsn > persistent_lsn_)
+    persistent_lsn_ = lsn;
+  cv_.notify_all();
+}
 
 /*
  * append a log record into log buffer
@@ -37,10 +92,66 @@ void LogManager::StopFlushThread() {}
  *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
  *  }
  *
+ * A full buffer is flushed first, by the flush thread if it runs.
  */
 lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
+  std::unique_lock<std::mutex> lck(latch_);
+  assert(static_cast<size_t>(log_record.size_) <= log_buffer_size_);
+  while (offset_ + log_record.size_ > log_buffer_size_) {
+    if (flush_running_) {
+      flush_requested_ = true;
+      cv_.notify_all();
+      cv_.wait(lck);
+    } else {
+      FlushLogBuffer(lck);
+    }
+  }
+
+  log_record.lsn_ = next_lsn_++;
+  memcpy(log_buffer_ + offset_, &log_record, LogRecord::HEADER_SIZE);
+  char *pos = log_buffer_ + offset_ + LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    memcpy(pos, &log_record.insert_rid_, sizeof(RID));
+    log_record.insert_tuple_.SerializeTo(pos + sizeof(RID));
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    memcpy(pos, &log_record.delete_rid_, sizeof(RID));
+    log_record.delete_tuple_.SerializeTo(pos + sizeof(RID));
+    break;
+  case LogRecordType::UPDATE:
+    memcpy(pos, &log_record.update_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.old_tuple_.SerializeTo(pos);
+    pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+    log_record.new_tuple_.SerializeTo(pos);
+    break;
+  case LogRecordType::NEWPAGE:
+    memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+    break;
+  default:
+    break;
+  }
+  offset_ += log_record.size_;
+  return log_record.lsn_;
+}
 
-  return INVALID_LSN;
+/*
+ * Used by the buffer pool before it writes a page whose LSN is larger than
+ * the persistent LSN (WAL). Returns at once when logging is disabled or the
+ * flush thread is not running (e.g. during shutdown): nothing would ever
+ * advance the persistent LSN. Nor does a page LSN no record has been given
+ * yet, see NeedsFlush.
+ */
+void LogManager::ForceFlush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lck(latch_);
+  while (ENABLE_LOGGING && flush_running_ && NeedsFlush(lsn)) {
+    flush_requested_ = true;
+    cv_.notify_all();
+    cv_.wait(lck);
+  }
 }
 
 } // namespace scudb
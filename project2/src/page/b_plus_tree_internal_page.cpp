@@ -18,12 +18,13 @@ namespace scudb {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
-                                          page_id_t parent_id) {
+                                          page_id_t parent_id,
+                                          size_t page_size) {
     this->SetPageType(IndexPageType::INTERNAL_PAGE);
     this->SetSize(1);
     this->SetPageId(page_id);
     this->SetParentPageId(parent_id);
-    int size = (PAGE_SIZE - sizeof(BPlusTreeInternalPage)) / (sizeof(KeyType) + sizeof(ValueType));
+    int size = (page_size - sizeof(BPlusTreeInternalPage)) / (sizeof(KeyType) + sizeof(ValueType));
     this->SetMaxSize(size);
 }
 /*
@@ -94,6 +95,25 @@ B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key,
     return array[GetSize() - 1].second;
 }
 
+/*
+ * Lookup for an optimistic reader: a writer may change the page under it, so
+ * the search is bounded by the size the reader saw (within the page) rather
+ * than the current one, and nothing is asserted. Returns the index of the
+ * child and its id in child, good only if the page's version validates
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupUnlatched(
+    const KeyType &key, int size, bool left_most, ValueType &child,
+    const KeyComparator &comparator) const {
+    int index = 0;
+    while(!left_most && index + 1 < size &&
+          comparator(key, array[index + 1].first) >= 0){
+        index++;
+    }
+    child = array[index].second;
+    return index;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -140,7 +160,7 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
     BPlusTreeInternalPage *recipient,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     // Move the right half part to the recipient
     int half = (GetSize() + 1) / 2;
     recipient->CopyHalfFrom(array + GetSize() - half, half, buffer_pool_manager);
@@ -158,7 +178,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(
-    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+    MappingType *items, int size, BufferPool *buffer_pool_manager) {
     
     assert(!IsLeafPage() && GetSize() == 1 && size > 0);
     memcpy(array, items, size * sizeof(MappingType));
@@ -201,7 +221,7 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
     BPlusTreeInternalPage *recipient, int index_in_parent,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     //
     assert(recipient->GetParentPageId() == GetParentPageId());
     int size = GetSize();
@@ -227,7 +247,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyAllFrom(
-    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+    MappingType *items, int size, BufferPool *buffer_pool_manager) {
     
     int current_size = GetSize();
     assert(current_size + size <= GetMaxSize());
@@ -245,7 +265,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyAllFrom(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
     BPlusTreeInternalPage *recipient,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     
     int size = GetSize();
     assert(size > GetMinSize());
@@ -263,7 +283,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(
-    const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+    const MappingType &pair, BufferPool *buffer_pool_manager) {
     
     int size = GetSize();
     array[size] = pair;
@@ -282,7 +302,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
     BPlusTreeInternalPage *recipient, int parent_index,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     
     int size = GetSize();
     assert(size > GetMinSize());
@@ -293,7 +313,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(
     const MappingType &pair, int parent_index,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     
     int size = GetSize();
     assert(size < GetMaxSize());
@@ -324,7 +344,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::QueueUpChildren(
     std::queue<BPlusTreePage *> *queue,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
   for (int i = 0; i < GetSize(); i++) {
     auto *page = buffer_pool_manager->FetchPage(array[i].second);
     if (page == nullptr)
@@ -22,13 +22,14 @@ namespace scudb
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id,
+                                      size_t page_size) {
     this->SetPageType(IndexPageType::LEAF_PAGE);
     this->SetSize(0);
     this->SetPageId(page_id);
     this->SetParentPageId(parent_id);
     this->SetNextPageId(INVALID_PAGE_ID);
-    int size = (PAGE_SIZE - sizeof(BPlusTreeLeafPage)) / (sizeof(KeyType) + sizeof(ValueType));
+    int size = (page_size - sizeof(BPlusTreeLeafPage)) / (sizeof(KeyType) + sizeof(ValueType));
     this->SetMaxSize(size);
 }
 
@@ -130,7 +131,7 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key,
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(
     BPlusTreeLeafPage *recipient,
-    __attribute__((unused)) BufferPoolManager *buffer_pool_manager) {
+    __attribute__((unused)) BufferPool *buffer_pool_manager) {
 
     int size = (GetSize() + 1 ) / 2;
     // Move the right half to the recipient
@@ -211,7 +212,7 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient,
-                                           int, BufferPoolManager *) {
+                                           int, BufferPool *) {
     //Move to left
     recipient->CopyAllFrom(array, GetSize());
     recipient->SetNextPageId(GetNextPageId());
@@ -237,7 +238,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyAllFrom(MappingType *items, int size) {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstTorightOf(
     BPlusTreeLeafPage *recipient,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     //
     recipient->CopyLastFrom(array[0]);
     memmove(array, array + 1, (GetSize() - 1) * sizeof(MappingType));
@@ -269,7 +270,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(
     BPlusTreeLeafPage *recipient, int parentIndex,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     //
     int size = GetSize();
     assert(size > GetMinSize());
@@ -280,7 +281,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(
     const MappingType &item, int parentIndex,
-    BufferPoolManager *buffer_pool_manager) {
+    BufferPool *buffer_pool_manager) {
     int size = GetSize();
     assert(size < GetMaxSize());
     memmove(array + 1, array, size * sizeof(MappingType));
@@ -8,6 +8,13 @@
 
 namespace scudb {
 
+void HeaderPage::Init() {
+  uint32_t format[3] = {DB_FORMAT_MAGIC, static_cast<uint32_t>(GetPageSize()),
+                        DB_FORMAT_SPACE_MAPS};
+  memcpy(GetData(), format, sizeof(format));
+  SetRecordCount(0);
+}
+
 /**
  * Record related
  */
@@ -17,9 +24,10 @@ bool HeaderPage::InsertRecord(const std::string &name,
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
-  // check for duplicate name
-  if (FindRecord(name) != -1)
+  int offset = RecordOffset(record_num);
+  // check for duplicate name or full page
+  if (FindRecord(name) != -1 ||
+      offset + 36 > static_cast<int>(GetPageSize()))
     return false;
   // copy record content
   memcpy(GetData() + offset, name.c_str(), (name.length() + 1));
@@ -37,7 +45,7 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
+  int offset = RecordOffset(index);
   memmove(GetData() + offset, GetData() + offset + 36,
           (record_num - index - 1) * 36);
 
@@ -53,7 +61,7 @@ bool HeaderPage::UpdateRecord(const std::string &name,
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
+  int offset = RecordOffset(index);
   // update record content, only root_id
   memcpy((GetData() + offset + 32), &root_id, 4);
 
@@ -67,7 +75,7 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = (index + 1) * 36;
+  int offset = RecordOffset(index) + 32;
   root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
 
   return true;
@@ -77,17 +85,19 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
  * helper functions
  */
 // record count
-int HeaderPage::GetRecordCount() { return *reinterpret_cast<int *>(GetData()); }
+int HeaderPage::GetRecordCount() {
+  return *reinterpret_cast<int *>(GetData() + 12);
+}
 
 void HeaderPage::SetRecordCount(int record_count) {
-  memcpy(GetData(), &record_count, 4);
+  memcpy(GetData() + 12, &record_count, 4);
 }
 
 int HeaderPage::FindRecord(const std::string &name) {
   int record_num = GetRecordCount();
 
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    char *raw_name = reinterpret_cast<char *>(GetData() + RecordOffset(i));
     if (strcmp(raw_name, name.c_str()) == 0)
       return i;
   }
@@ -314,6 +314,42 @@ bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
   return true;
 }
 
+bool TablePage::GetTupleOptimistic(const RID &rid, Tuple &tuple,
+                                   uint64_t version, bool &found) {
+  // reads under 2PL need the lock manager, and so the latch
+  if (ENABLE_LOGGING)
+    return false;
+  // a writer may change the page under us: bound every read by the page
+  int slot_num = rid.GetSlotNum();
+  int32_t tuple_offset = 0;
+  int32_t tuple_size = 0;
+  if (slot_num >= 0 && slot_num < GetTupleCount() &&
+      24 + 8 * (static_cast<size_t>(slot_num) + 1) <= GetPageSize()) {
+    tuple_offset = GetTupleOffset(slot_num);
+    tuple_size = GetTupleSize(slot_num);
+  }
+  found = tuple_size > 0 && tuple_offset >= 0 &&
+          static_cast<size_t>(tuple_offset) + tuple_size <= GetPageSize();
+  char *data = nullptr;
+  if (found) {
+    data = new char[tuple_size];
+    memcpy(data, GetData() + tuple_offset, tuple_size);
+  }
+  if (!ValidateVersion(version)) {
+    delete[] data;
+    return false;
+  }
+  if (found) {
+    if (tuple.allocated_)
+      delete[] tuple.data_;
+    tuple.size_ = tuple_size;
+    tuple.data_ = data;
+    tuple.rid_ = rid;
+    tuple.allocated_ = true;
+  }
+  return true;
+}
+
 /**
  * Tuple iterator
  */
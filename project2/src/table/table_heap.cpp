@@ -10,31 +10,35 @@
 namespace scudb {
 
 // open table
-TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
+TableHeap::TableHeap(BufferPool *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
                      page_id_t first_page_id)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-      log_manager_(log_manager), first_page_id_(first_page_id) {}
+      log_manager_(log_manager), first_page_id_(first_page_id),
+      num_pages_(0) {}
 
 // create table
-TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
+TableHeap::TableHeap(BufferPool *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager), num_pages_(1) {
   auto first_page =
-      static_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
+      static_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_,
+                                                             &extent_));
   assert(first_page != nullptr); // todo: abort table creation?
   first_page->WLatch();
   LOG_DEBUG("new table page created %d", first_page_id_);
 
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, first_page->GetPageSize(), INVALID_LSN,
+                   log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
+  if (static_cast<size_t>(tuple.size_ + 32) >
+      buffer_pool_manager_->GetPageSize()) { // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
@@ -59,7 +63,8 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
       cur_page->WLatch();
     } else { // create new page
       auto new_page =
-          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
+          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id,
+                                                                 &extent_));
       if (new_page == nullptr) {
         cur_page->WUnlatch();
         buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
@@ -70,8 +75,9 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
       // std::cout << "new table page " << next_page_id << " created" <<
       // std::endl;
       cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
-                     log_manager_, txn);
+      num_pages_++;
+      new_page->Init(next_page_id, new_page->GetPageSize(),
+                     cur_page->GetPageId(), log_manager_, txn);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
       cur_page = new_page;
@@ -141,6 +147,20 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
 
 // called by tuple iterator
 bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
+  // first try reading a resident page without pin or latch
+  for (int i = 0; i < OPTIMISTIC_READ_RETRIES; ++i) {
+    uint64_t version;
+    auto page = static_cast<TablePage *>(
+        buffer_pool_manager_->FetchPageOptimistic(rid.GetPageId(), version));
+    if (page == nullptr)
+      break;
+    bool found;
+    if ((version & 1) == 0 &&
+        page->GetTupleOptimistic(rid, tuple, version, found))
+      return found;
+    if (ENABLE_LOGGING)
+      break;
+  }
   auto page = static_cast<TablePage *>(
       buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) {
@@ -159,9 +179,13 @@ bool TableHeap::DeleteTableHeap() {
   return true;
 }
 
-TableIterator TableHeap::begin(Transaction *txn) {
-  auto page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+TableIterator TableHeap::begin(Transaction *txn, bool use_ring) {
+  std::shared_ptr<BufferRing> ring;
+  if (use_ring)
+    ring = std::make_shared<BufferRing>();
+  auto page = static_cast<TablePage *>(
+      use_ring ? buffer_pool_manager_->FetchPage(first_page_id_, ring.get())
+               : buffer_pool_manager_->FetchPage(first_page_id_));
   page->RLatch();
   RID rid;
   // if failed (no tuple), rid will be the result of default
@@ -169,7 +193,7 @@ TableIterator TableHeap::begin(Transaction *txn) {
   page->GetFirstTupleRid(rid);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, ring);
 }
 
 TableIterator TableHeap::end() {
@@ -8,13 +8,34 @@
 
 namespace scudb {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+static page_id_t NextTablePage(Page *page) {
+  return static_cast<TablePage *>(page)->GetNextPageId();
+}
+
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                             std::shared_ptr<BufferRing> ring)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn),
+      ring_(std::move(ring)), num_pages_(1) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
   }
 };
 
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)),
+      txn_(other.txn_), ring_(other.ring_), num_pages_(other.num_pages_) {}
+
+TableIterator &TableIterator::operator=(const TableIterator &other) {
+  if (this != &other) {
+    table_heap_ = other.table_heap_;
+    *tuple_ = *other.tuple_;
+    txn_ = other.txn_;
+    ring_ = other.ring_;
+    num_pages_ = other.num_pages_;
+  }
+  return *this;
+}
+
 const Tuple &TableIterator::operator*() {
   assert(*this != table_heap_->end());
   return *tuple_;
@@ -26,9 +47,9 @@ Tuple *TableIterator::operator->() {
 }
 
 TableIterator &TableIterator::operator++() {
-  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(
-      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  BufferPool *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  auto cur_page =
+      static_cast<TablePage *>(FetchPage(tuple_->rid_.GetPageId()));
   cur_page->RLatch();
   assert(cur_page != nullptr); // all pages are pinned
 
@@ -36,12 +57,23 @@ TableIterator &TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  next_tuple_rid)) { // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(
-          buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page =
+          static_cast<TablePage *>(FetchPage(cur_page->GetNextPageId()));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      num_pages_++;
+      // a heap reopened since its last full scan does not know its size, go
+      // on through a ring once the scan turns out to be a large one
+      if (ring_ == nullptr &&
+          num_pages_ > buffer_pool_manager->GetPoolSize() / SCAN_RING_THRESHOLD)
+        ring_ = std::make_shared<BufferRing>();
+      // the scan walks the page chain, read the following pages ahead. Not
+      // for a ring scan, read-ahead would fill frames outside its ring
+      if (ring_ == nullptr)
+        buffer_pool_manager->ReadAhead(cur_page->GetNextPageId(),
+                                       NextTablePage);
       if (cur_page->GetFirstTupleRid(next_tuple_rid))
         break;
     }
@@ -50,6 +82,9 @@ TableIterator &TableIterator::operator++() {
 
   if (*this != table_heap_->end()) {
     table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+  } else {
+    // walked the whole chain, remember how large the heap is
+    table_heap_->num_pages_ = num_pages_;
   }
   // release until copy the tuple
   cur_page->RUnlatch();
@@ -57,6 +92,13 @@ TableIterator &TableIterator::operator++() {
   return *this;
 }
 
+Page *TableIterator::FetchPage(page_id_t page_id) {
+  BufferPool *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (ring_ != nullptr)
+    return buffer_pool_manager->FetchPage(page_id, ring_.get());
+  return buffer_pool_manager->FetchPage(page_id);
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
@@ -2,6 +2,7 @@
  * virtual_table.cpp
  */
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <sys/stat.h>
@@ -17,6 +18,50 @@ namespace scudb {
 
 SQLITE_EXTENSION_INIT1
 
+/*
+ * The module arguments after the schema: the index definition, and options
+ * pool=name:min_frames[:max_frames] to put the table and its index into a
+ * partition of the buffer pool, index_pool=... to give the index its own.
+ * Returns false with error set for a bad option: nothing may be thrown
+ * through sqlite.
+ */
+static bool ParseArguments(int argc, const char *const *argv,
+                           std::string &index_string,
+                           BufferPool *&table_pool, BufferPool *&index_pool,
+                           std::string &error) {
+  BufferPoolManager *buffer_pool_manager =
+      storage_engine_->buffer_pool_manager_;
+  index_pool = nullptr;
+  for (int i = 4; i < argc; i++) {
+    std::string arg(argv[i]);
+    // remove the very first and last character
+    arg = arg.substr(1, (arg.size() - 2));
+    std::string::size_type n = arg.find_first_of('=');
+    if (n == std::string::npos) {
+      index_string = arg;
+      continue;
+    }
+    std::string option = arg.substr(0, n);
+    StringUtility::Trim(option);
+    BufferPool *pool;
+    if (option == "pool") {
+      pool = table_pool = ParsePoolStatement(arg.substr(n + 1),
+                                             buffer_pool_manager, error);
+    } else if (option == "index_pool") {
+      pool = index_pool = ParsePoolStatement(arg.substr(n + 1),
+                                             buffer_pool_manager, error);
+    } else {
+      error = "unknown vtable option " + option;
+      return false;
+    }
+    if (pool == nullptr)
+      return false;
+  }
+  if (index_pool == nullptr)
+    index_pool = table_pool;
+  return true;
+}
+
 /* API implementation */
 int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
                sqlite3_vtab **ppVtab, char **pzErr) {
@@ -25,9 +70,9 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   LockManager *lock_manager = storage_engine_->lock_manager_;
   LogManager *log_manager = storage_engine_->log_manager_;
 
-  // fetch header page from buffer pool
-  HeaderPage *header_page =
-      static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  // fetch header page from buffer pool, the catalog stays in memory
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID, PagePriority::ROOT));
 
   // the first three parameter:(1) module name (2) database name (3)table name
   assert(argc >= 4);
@@ -36,19 +81,28 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   schema_string = schema_string.substr(1, (schema_string.size() - 2));
   Schema *schema = ParseCreateStatement(schema_string);
 
-  // parse arg[4](string that defines table index)
+  // parse arg[4](string that defines table index) and the options
+  std::string index_string;
+  BufferPool *table_pool = buffer_pool_manager;
+  BufferPool *index_pool;
+  std::string error;
+  if (!ParseArguments(argc, argv, index_string, table_pool, index_pool,
+                      error)) {
+    delete schema;
+    buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
+    *pzErr = sqlite3_mprintf("%s", error.c_str());
+    return SQLITE_ERROR;
+  }
   Index *index = nullptr;
-  if (argc > 4) {
-    std::string index_string(argv[4]);
-    index_string = index_string.substr(1, (index_string.size() - 2));
+  if (!index_string.empty()) {
     // create index object, allocate memory space
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
-    index = ConstructIndex(index_metadata, buffer_pool_manager);
+    index = ConstructIndex(index_metadata, index_pool);
   }
   // create table object, allocate memory space
-  VirtualTable *table = new VirtualTable(schema, buffer_pool_manager,
-                                         lock_manager, log_manager, index);
+  VirtualTable *table = new VirtualTable(schema, table_pool, lock_manager,
+                                         log_manager, index);
 
   // insert table root page info into header page
   header_page->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
@@ -77,26 +131,34 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   LogManager *log_manager = storage_engine_->log_manager_;
 
   // Retrieve table root page info from header page
-  HeaderPage *header_page =
-      static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID, PagePriority::ROOT));
   page_id_t table_root_id;
   header_page->GetRootId(std::string(argv[2]), table_root_id);
-  // parse arg[4](string that defines table index)
+  // parse arg[4](string that defines table index) and the options
+  std::string index_string;
+  BufferPool *table_pool = buffer_pool_manager;
+  BufferPool *index_pool;
+  std::string error;
+  if (!ParseArguments(argc, argv, index_string, table_pool, index_pool,
+                      error)) {
+    delete schema;
+    buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
+    *pzErr = sqlite3_mprintf("%s", error.c_str());
+    return SQLITE_ERROR;
+  }
   Index *index = nullptr;
-  if (argc > 4) {
-    std::string index_string(argv[4]);
-    index_string = index_string.substr(1, (index_string.size() - 2));
+  if (!index_string.empty()) {
     // create index object, allocate memory space
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
     // Retrieve index root page info from header page
     page_id_t index_root_id;
     header_page->GetRootId(index_metadata->GetName(), index_root_id);
-    index = ConstructIndex(index_metadata, buffer_pool_manager, index_root_id);
+    index = ConstructIndex(index_metadata, index_pool, index_root_id);
   }
-  VirtualTable *table =
-      new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
-                       index, table_root_id);
+  VirtualTable *table = new VirtualTable(schema, table_pool, lock_manager,
+                                         log_manager, index, table_root_id);
 
   // register virtual table within sqlite system
   schema_string = "CREATE TABLE X(" + schema_string + ");";
@@ -196,6 +258,8 @@ int VtabFilter(sqlite3_vtab_cursor *pVtabCursor, int idxNum, const char *idxStr,
     key_schema = cursor->GetKeySchema();
     Tuple scan_tuple = ConstructTuple(key_schema, argv);
     cursor->ScanKey(scan_tuple);
+  } else {
+    cursor->BeginSeqScan();
   }
   return SQLITE_OK;
 }
@@ -348,6 +412,14 @@ sqlite3_module VtableModule = {
     0,              /* xRollbackTo */
 };
 
+// startup setting from the environment, e.g. SCUDB_POOL_SIZE=1024
+static size_t GetSetting(const char *name, size_t default_value) {
+  const char *value = getenv(name);
+  if (value == nullptr)
+    return default_value;
+  return strtoul(value, nullptr, 10);
+}
+
 #ifdef _WIN32
 __declspec(dllexport)
 #endif
@@ -358,17 +430,30 @@ __declspec(dllexport)
   struct stat buffer;
   bool is_file_exist = (stat(db_file_name.c_str(), &buffer) == 0);
 
-  // init storage engine
-  storage_engine_ = new StorageEngine(db_file_name);
+  // init storage engine, the page size only matters for a new database
+  try {
+    storage_engine_ = new StorageEngine(
+        db_file_name, GetSetting("SCUDB_POOL_SIZE", BUFFER_POOL_SIZE),
+        GetSetting("SCUDB_PAGE_SIZE", PAGE_SIZE),
+        GetSetting("SCUDB_MAX_POOL_SIZE", 0),
+        GetSetting("SCUDB_COMPRESSED_CACHE_SIZE", 0),
+        GetSetting("SCUDB_SHARED_CACHE_SIZE", 0));
+  } catch (Exception &e) {
+    *pzErrMsg = sqlite3_mprintf("%s", e.what());
+    return SQLITE_ERROR;
+  }
   // start the logging
   storage_engine_->log_manager_->RunFlushThread();
   // create header page from BufferPoolManager if necessary
   if (!is_file_exist) {
     page_id_t header_page_id;
-    storage_engine_->buffer_pool_manager_->NewPage(header_page_id);
+    HeaderPage *header_page = static_cast<HeaderPage *>(
+        storage_engine_->buffer_pool_manager_->NewPage(header_page_id));
 
     assert(header_page_id == HEADER_PAGE_ID);
-    storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true);
+    header_page->Init();
+    storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true,
+                                                     PagePriority::ROOT);
   }
 
   int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
@@ -469,6 +554,35 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
   return metadata;
 }
 
+// a frame count of the pool statement, false unless it is a plain number
+static bool ParseFrames(const std::string &tok, size_t &frames) {
+  if (tok.empty() || tok.size() > 9 ||
+      !std::all_of(tok.begin(), tok.end(), ::isdigit))
+    return false;
+  frames = std::strtoul(tok.c_str(), nullptr, 10);
+  return true;
+}
+
+BufferPool *ParsePoolStatement(const std::string &sql,
+                               BufferPoolManager *buffer_pool_manager,
+                               std::string &error) {
+  std::vector<std::string> tok = StringUtility::Split(sql, ':');
+  size_t min_frames, max_frames = 0;
+  if (tok.size() < 2 || tok.size() > 3 || tok[0].empty() ||
+      !ParseFrames(tok[1], min_frames) ||
+      (tok.size() == 3 && !ParseFrames(tok[2], max_frames))) {
+    error = "pool format is name:min_frames[:max_frames]";
+    return nullptr;
+  }
+  try {
+    return buffer_pool_manager->CreatePartition(tok[0], min_frames,
+                                                max_frames);
+  } catch (Exception &e) {
+    error = e.what();
+    return nullptr;
+  }
+}
+
 Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
   int column_count = schema->GetColumnCount();
   Value v(TypeId::INVALID);
@@ -506,7 +620,7 @@ Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
 
 // serve the functionality of index factory
 Index *ConstructIndex(IndexMetadata *metadata,
-                      BufferPoolManager *buffer_pool_manager,
+                      BufferPool *buffer_pool_manager,
                       page_id_t root_id) {
   // The size of the key in bytes
   Schema *key_schema = metadata->GetKeySchema();
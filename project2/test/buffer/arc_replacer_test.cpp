@@ -0,0 +1,116 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer<int> arc_replacer(4);
+
+  // push element into replacer, everything seen once lands in T1
+  arc_replacer.Insert(0);
+  arc_replacer.Insert(1);
+  arc_replacer.Insert(2);
+  arc_replacer.Insert(3);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetTargetRecencySize());
+
+  int value;
+  arc_replacer.Victim(value);
+  EXPECT_EQ(0, value);
+
+  // hit in ghost list B1: T1 was too small
+  arc_replacer.Insert(0);
+  EXPECT_EQ(1, arc_replacer.GetTargetRecencySize());
+  EXPECT_EQ(3, arc_replacer.GetTargetFrequencySize());
+  // second access moves 1 to T2
+  arc_replacer.Insert(1);
+
+  // T1 is above its target
+  arc_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  // T1 is at its target, take from T2
+  arc_replacer.Victim(value);
+  EXPECT_EQ(0, value);
+
+  // hit in ghost list B2: T2 was too small
+  arc_replacer.Insert(0);
+  EXPECT_EQ(0, arc_replacer.GetTargetRecencySize());
+  EXPECT_EQ(4, arc_replacer.GetTargetFrequencySize());
+
+  // remove element from replacer
+  EXPECT_EQ(true, arc_replacer.Erase(3));
+  EXPECT_EQ(false, arc_replacer.Erase(3));
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // 3 is pinned, fall back to T2
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(false, arc_replacer.Victim(value));
+}
+
+/*
+ * Hit ratio on a trace mixing point lookups over a small hot set (index
+ * pages) with repeated full scans over a larger table.
+ */
+static double MixedTraceHitRatio(ReplacerType replacer_type) {
+  const int pool_size = 32;
+  const int num_hot_pages = 16;
+  const int num_pages = 256;
+  const int num_rounds = 20;
+  const int lookups_per_round = 400;
+
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(pool_size, &disk_manager, nullptr, replacer_type);
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; ++i) {
+    bpm.NewPage(page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<int> hot(0, num_hot_pages - 1);
+  std::uniform_int_distribution<int> any(0, num_pages - 1);
+  std::uniform_int_distribution<int> percent(0, 99);
+  size_t hits = bpm.GetNumHits();
+  size_t misses = bpm.GetNumMisses();
+  for (int round = 0; round < num_rounds; ++round) {
+    for (int i = 0; i < lookups_per_round; ++i) {
+      page_id = percent(generator) < 90 ? hot(generator) : any(generator);
+      bpm.FetchPage(page_id);
+      bpm.UnpinPage(page_id, false);
+    }
+    for (page_id = num_hot_pages; page_id < num_pages; ++page_id) {
+      bpm.FetchPage(page_id);
+      bpm.UnpinPage(page_id, false);
+    }
+  }
+  hits = bpm.GetNumHits() - hits;
+  misses = bpm.GetNumMisses() - misses;
+
+  remove("test.db");
+  remove("test.log");
+  return static_cast<double>(hits) / (hits + misses);
+}
+
+TEST(ARCReplacerTest, HitRatioBenchmark) {
+  double lru = MixedTraceHitRatio(ReplacerType::LRU);
+  double clock = MixedTraceHitRatio(ReplacerType::CLOCK);
+  double lru_k = MixedTraceHitRatio(ReplacerType::LRU_K);
+  double arc = MixedTraceHitRatio(ReplacerType::ARC);
+  printf("hit ratio on mixed scan/lookup trace\n");
+  printf("  LRU   %.4f\n  CLOCK %.4f\n  LRU-K %.4f\n  ARC   %.4f\n", lru,
+         clock, lru_k, arc);
+  EXPECT_GT(arc, lru);
+}
+
+} // namespace scudb
@@ -2,9 +2,21 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <random>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_partition.h"
+#include "common/exception.h"
+#include "vtable/virtual_table.h"
 #include "gtest/gtest.h"
 
 namespace scudb {
@@ -48,4 +60,788 @@ TEST(BufferPoolManagerTest, SampleTest) {
   remove("test.db");
 }
 
+TEST(BufferPoolManagerTest, ConcurrentTest) {
+  const int num_threads = 8;
+  const int num_pages = 40;
+  const int num_rounds = 500;
+
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(5, &disk_manager);
+  page_id_t temp_page_id;
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  // every page holds a counter; threads bump random pages while the small
+  // pool keeps evicting and rereading them
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 generator(t);
+      std::uniform_int_distribution<int> any(0, num_pages - 1);
+      for (int i = 0; i < num_rounds; ++i) {
+        page_id_t page_id = any(generator);
+        Page *page = bpm.FetchPage(page_id);
+        while (page == nullptr) {
+          std::this_thread::yield();
+          page = bpm.FetchPage(page_id);
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        page->WLatch();
+        (*reinterpret_cast<int *>(page->GetData()))++;
+        page->WUnlatch();
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  // no increment was lost to a stale read or a missed write-back
+  int total = 0;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    total += *reinterpret_cast<int *>(page->GetData());
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_threads * num_rounds, total);
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, OptimisticReadTest) {
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(2, &disk_manager);
+  Page *page = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page);
+  strcpy(page->GetData(), "Hello");
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+
+  // a resident page is read without pinning it
+  uint64_t version;
+  EXPECT_EQ(page, bpm.FetchPageOptimistic(temp_page_id, version));
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_EQ(0, strcmp(page->GetData(), "Hello"));
+  EXPECT_EQ(true, page->ValidateVersion(version));
+
+  // a writer invalidates the read
+  page = bpm.FetchPage(temp_page_id);
+  page->WLatch();
+  uint64_t write_version;
+  EXPECT_EQ(page, bpm.FetchPageOptimistic(temp_page_id, write_version));
+  EXPECT_EQ(1, write_version & 1);
+  page->WUnlatch();
+  EXPECT_EQ(false, page->ValidateVersion(version));
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+
+  // and so does evicting the page
+  EXPECT_EQ(page, bpm.FetchPageOptimistic(temp_page_id, version));
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  EXPECT_EQ(false, page->ValidateVersion(version));
+  EXPECT_EQ(nullptr, bpm.FetchPageOptimistic(0, version));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, SwizzleTest) {
+  page_id_t parent_id, child_id, temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(3, &disk_manager);
+  Page *parent = bpm.NewPage(parent_id);
+  ASSERT_NE(nullptr, parent);
+  ASSERT_NE(nullptr, bpm.NewPage(child_id));
+  EXPECT_EQ(true, bpm.UnpinPage(child_id, true));
+
+  // the first fetch goes through the page table and swizzles the slot
+  uint64_t version;
+  Page *child = bpm.FetchChildOptimistic(parent, 5, child_id, version);
+  ASSERT_NE(nullptr, child);
+  EXPECT_EQ(child_id, child->GetPageId());
+  EXPECT_EQ(0, bpm.GetNumSwizzleHits());
+  EXPECT_EQ(child, bpm.FetchChildOptimistic(parent, 5, child_id, version));
+  EXPECT_EQ(1, bpm.GetNumSwizzleHits());
+  // a stale reference is not followed
+  EXPECT_EQ(nullptr, bpm.FetchChildOptimistic(parent, 5, 42, version));
+
+  // the frame pins without a lookup while it holds the page
+  EXPECT_EQ(child, bpm.FetchFrame(child, child_id));
+  EXPECT_EQ(1, child->GetPinCount());
+  EXPECT_EQ(true, bpm.UnpinPage(child_id, false));
+
+  // evicting the child unswizzles the slot
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  EXPECT_EQ(nullptr, bpm.FetchChildOptimistic(parent, 5, child_id, version));
+  ASSERT_NE(nullptr, bpm.FetchPage(child_id));
+  EXPECT_EQ(true, bpm.UnpinPage(child_id, false));
+  EXPECT_NE(nullptr, bpm.FetchChildOptimistic(parent, 5, child_id, version));
+  EXPECT_EQ(1, bpm.GetNumSwizzleHits());
+  EXPECT_EQ(true, bpm.UnpinPage(parent_id, false));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, WideSwizzleTest) {
+  // as many children as an internal page of 8 byte keys holds
+  const int num_children = (PAGE_SIZE - 24) / 12;
+  page_id_t parent_id, temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(num_children + 1, &disk_manager);
+  size_t memory_usage = bpm.GetMemoryUsage();
+  Page *parent = bpm.NewPage(parent_id);
+  ASSERT_NE(nullptr, parent);
+  std::vector<page_id_t> children;
+  for (int i = 0; i < num_children; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    children.push_back(temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+
+  // the first descent swizzles every slot, the next ones take all the
+  // children from the parent's table without the page table
+  uint64_t version;
+  for (int pass = 0; pass < 3; ++pass) {
+    for (int i = 0; i < num_children; ++i) {
+      Page *child =
+          bpm.FetchChildOptimistic(parent, i, children[i], version);
+      ASSERT_NE(nullptr, child);
+      EXPECT_EQ(children[i], child->GetPageId());
+    }
+    EXPECT_EQ(pass * num_children, bpm.GetNumSwizzleHits());
+  }
+  // only the parent's frame got a table
+  EXPECT_LT(memory_usage, bpm.GetMemoryUsage());
+  EXPECT_GE(memory_usage + PAGE_SIZE, bpm.GetMemoryUsage());
+  EXPECT_EQ(true, bpm.UnpinPage(parent_id, false));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  page_id_t temp_page_id;
+  BG_WRITER_DELAY = std::chrono::milliseconds(10);
+
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(10, &disk_manager);
+  for (int i = 0; i < 10; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", i);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  // the writer cleans the pages LRU would evict next
+  bpm.RunWriterThread();
+  for (int i = 0; i < 500 && bpm.GetNumPagesCleaned() < BG_WRITER_MAX_PAGES;
+       ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(BG_WRITER_MAX_PAGES, bpm.GetNumPagesCleaned());
+  EXPECT_LT(0, bpm.GetWriterFlushRate());
+
+  // so evicting them costs no foreground write
+  for (int i = 0; i < BG_WRITER_MAX_PAGES; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  EXPECT_EQ(0, bpm.GetNumForegroundWrites());
+  bpm.StopWriterThread();
+
+  // and the content made it to disk
+  Page *page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "page-0"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+  BG_WRITER_DELAY = std::chrono::milliseconds(100);
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ReadAheadTest) {
+  const int num_pages = 20;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  {
+    // a chain of pages, each holding the id of the next one
+    BufferPoolManager bpm(10, &disk_manager);
+    for (int i = 0; i < num_pages; ++i) {
+      Page *page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      page_id_t next = i + 1 < num_pages ? temp_page_id + 1 : INVALID_PAGE_ID;
+      memcpy(page->GetData(), &next, sizeof(page_id_t));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+      EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+    }
+  }
+  auto next_page = [](Page *page) {
+    page_id_t next;
+    memcpy(&next, page->GetData(), sizeof(page_id_t));
+    return next;
+  };
+
+  // read the window after page 0 ahead, fetching it is then all hits
+  BufferPoolManager bpm(10, &disk_manager);
+  bpm.SetPrefetchWindow(6);
+  bpm.ReadAhead(1, next_page);
+  for (int i = 0; i < 500 && bpm.GetNumPrefetched() < 6; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(6, bpm.GetNumPrefetched());
+  for (page_id_t page_id = 1; page_id <= 6; ++page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id + 1, next_page(page));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(6, bpm.GetNumHits());
+  EXPECT_EQ(0, bpm.GetNumMisses());
+
+  // a window of 0 turns read-ahead off
+  bpm.SetPrefetchWindow(0);
+  bpm.ReadAhead(7, next_page);
+  EXPECT_NE(nullptr, bpm.FetchPage(7));
+  EXPECT_EQ(1, bpm.GetNumMisses());
+  EXPECT_EQ(true, bpm.UnpinPage(7, false));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, WarmUpTest) {
+  const int num_pages = 200;
+  const int pool_size = 40;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  // two runs of hot pages
+  std::vector<page_id_t> hot_pages;
+  for (page_id_t page_id = 20; page_id < 40; ++page_id) {
+    hot_pages.push_back(page_id);
+    hot_pages.push_back(page_id + 100);
+  }
+  {
+    BufferPoolManager bpm(pool_size + 10, &disk_manager);
+    for (int i = 0; i < num_pages; ++i) {
+      Page *page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page-%d", i);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+      EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+    }
+    for (int round = 0; round < 3; ++round) {
+      for (page_id_t page_id : hot_pages) {
+        ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+      }
+    }
+    // the writer saves an image when it stops
+    bpm.SetWarmImageFile("test.warm");
+    bpm.RunWriterThread();
+    bpm.StopWriterThread();
+  }
+
+  // cold start: the hot pages fault in one at a time
+  BufferPoolManager cold_bpm(pool_size, &disk_manager);
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id : hot_pages) {
+    ASSERT_NE(nullptr, cold_bpm.FetchPage(page_id));
+    EXPECT_EQ(true, cold_bpm.UnpinPage(page_id, false));
+  }
+  std::chrono::duration<double> cold_time =
+      std::chrono::steady_clock::now() - start;
+
+  // warm start: the hottest pages of the image, the cold ones are left out
+  BufferPoolManager bpm(pool_size, &disk_manager);
+  EXPECT_EQ(static_cast<size_t>(pool_size), bpm.WarmUp("test.warm"));
+  EXPECT_LT(0, bpm.GetWarmUpTime());
+  for (page_id_t page_id : hot_pages) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(),
+                        ("page-" + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm.GetNumMisses());
+  std::cout << "time to warm " << hot_pages.size() << " pages: "
+            << cold_time.count() << "s faulting in, " << bpm.GetWarmUpTime()
+            << "s from the image" << std::endl;
+
+  // no image, nothing to load
+  EXPECT_EQ(0, bpm.WarmUp("test.none"));
+
+  remove("test.db");
+  remove("test.warm");
+}
+
+TEST(BufferPoolManagerTest, RingScanTest) {
+  const int pool_size = 20;
+  const int num_hot = 10;
+  const int num_pages = 110;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(pool_size, &disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  auto fetch_hot = [&bpm]() {
+    for (page_id_t page_id = 0; page_id < num_hot; ++page_id) {
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+    }
+  };
+  fetch_hot();
+
+  // a scan through a ring only recycles its own frames
+  size_t num_misses = bpm.GetNumMisses();
+  BufferRing ring;
+  for (page_id_t page_id = num_hot; page_id < num_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm.FetchPage(page_id, &ring));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_LE(num_misses + num_pages - pool_size, bpm.GetNumMisses());
+  num_misses = bpm.GetNumMisses();
+  fetch_hot();
+  EXPECT_EQ(num_misses, bpm.GetNumMisses());
+
+  // the same scan without a ring flushes the hot pages out
+  for (page_id_t page_id = num_hot; page_id < num_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  num_misses = bpm.GetNumMisses();
+  fetch_hot();
+  EXPECT_EQ(num_misses + num_hot, bpm.GetNumMisses());
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const int num_pages = 30;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(10, &disk_manager, nullptr, ReplacerType::LRU, 40);
+  EXPECT_EQ(10, bpm.GetPoolSize());
+  EXPECT_EQ(40, bpm.GetMaxPoolSize());
+  size_t memory_usage = bpm.GetMemoryUsage();
+
+  // growing adds free frames, nothing gets evicted
+  bpm.Resize(num_pages);
+  EXPECT_EQ(num_pages, bpm.GetPoolSize());
+  EXPECT_EQ(memory_usage + 20 * bpm.GetPageSize(), bpm.GetMemoryUsage());
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", i);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  EXPECT_EQ(0, bpm.GetNumForegroundWrites());
+
+  // shrinking waits for a pinned page above the new size, but the rest of
+  // the pool keeps serving meanwhile, misses included
+  Page *pinned = bpm.FetchPage(num_pages - 1);
+  ASSERT_NE(nullptr, pinned);
+  EXPECT_LE(5, pinned->GetFrameId());
+  std::thread resize([&bpm] { bpm.Resize(5); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(5, bpm.GetPoolSize());
+  ASSERT_NE(nullptr, bpm.FetchPage(1));
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+  size_t num_misses = bpm.GetNumMisses();
+  ASSERT_NE(nullptr, bpm.FetchPage(num_pages - 2));
+  EXPECT_EQ(num_misses + 1, bpm.GetNumMisses());
+  EXPECT_EQ(true, bpm.UnpinPage(num_pages - 2, false));
+  EXPECT_EQ(true, bpm.UnpinPage(num_pages - 1, false));
+  resize.join();
+  EXPECT_EQ(memory_usage - 5 * bpm.GetPageSize(), bpm.GetMemoryUsage());
+
+  // the dirty pages taken away were written back
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_LT(page->GetFrameId(), 5);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page-" + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  // a hot page on a frame being taken away does not hold the shrink off:
+  // its fetches wait for the frame to go and read the page in again
+  bpm.Resize(num_pages);
+  page_id_t hot_page_id = INVALID_PAGE_ID;
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    if (page->GetFrameId() >= 10) hot_page_id = i;
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  ASSERT_NE(INVALID_PAGE_ID, hot_page_id);
+  std::atomic<bool> resized(false);
+  std::thread hot([&bpm, &resized, hot_page_id] {
+    while (!resized) {
+      ASSERT_NE(nullptr, bpm.FetchPage(hot_page_id));
+      bpm.UnpinPage(hot_page_id, false);
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  bpm.Resize(10);
+  resized = true;
+  hot.join();
+  EXPECT_EQ(10, bpm.GetPoolSize());
+  Page *hot_page = bpm.FetchPage(hot_page_id);
+  ASSERT_NE(nullptr, hot_page);
+  EXPECT_LT(hot_page->GetFrameId(), 10);
+  EXPECT_EQ(0, strcmp(hot_page->GetData(),
+                      ("page-" + std::to_string(hot_page_id)).c_str()));
+  EXPECT_EQ(true, bpm.UnpinPage(hot_page_id, false));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, CompressedCacheTest) {
+  const int num_pages = 40;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(10, &disk_manager);
+  bpm.EnableCompressedCache(num_pages * bpm.GetPageSize() / 2);
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    for (int row = 0; row < 32; ++row)
+      snprintf(page->GetData() + row * 32, 32, "page-%d row-%d", i, row);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+  }
+
+  // the pages that no longer fit into the pool come back from the tier
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < num_pages; ++i) {
+      Page *page = bpm.FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData() + 32,
+                          ("page-" + std::to_string(i) + " row-1").c_str()));
+      EXPECT_EQ(true, bpm.UnpinPage(i, false));
+    }
+  }
+  EXPECT_EQ(bpm.GetNumMisses(),
+            bpm.GetNumCompressedHits() + bpm.GetNumCompressedMisses());
+  EXPECT_LT(bpm.GetNumMisses() / 2, bpm.GetNumCompressedHits());
+
+  // a page written back drops its stale compressed copy
+  Page *page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  strcpy(page->GetData(), "changed");
+  EXPECT_EQ(true, bpm.UnpinPage(0, true));
+  for (int i = 1; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "changed"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, DeletePageTest) {
+  const int num_pages = 50;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(10, &disk_manager);
+  ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(HEADER_PAGE_ID, temp_page_id);
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+
+  // deleted pages are reused, the file stops growing
+  struct stat stat_buf;
+  off_t file_size = 0;
+  for (int round = 0; round < 5; ++round) {
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      page_ids.push_back(temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    EXPECT_EQ(num_pages, page_ids.back());
+    // most of them were evicted already
+    for (auto page_id : page_ids)
+      EXPECT_EQ(true, bpm.DeletePage(page_id));
+    EXPECT_EQ(static_cast<size_t>(num_pages), disk_manager.GetNumFreePages());
+    ASSERT_EQ(0, stat("test.db", &stat_buf));
+    if (round == 0)
+      file_size = stat_buf.st_size;
+    EXPECT_EQ(file_size, stat_buf.st_size);
+  }
+  EXPECT_EQ(num_pages + 1, disk_manager.GetNextPageId());
+
+  // a pinned page stays
+  ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(1, temp_page_id);
+  EXPECT_EQ(false, bpm.DeletePage(temp_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, FlushPageTest) {
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(10, &disk_manager);
+  Page *page = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page);
+  page_id_t flushed_page_id = temp_page_id;
+  ASSERT_NE(nullptr, bpm.FetchPage(flushed_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(flushed_page_id, true));
+
+  // the flush waits for the write latch, the pool is not held up meanwhile
+  page->WLatch();
+  std::thread flusher(
+      [&bpm, flushed_page_id] { EXPECT_TRUE(bpm.FlushPage(flushed_page_id)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  snprintf(page->GetData(), 32, "flushed");
+  page->WUnlatch();
+  flusher.join();
+
+  // the disk has what the page held when the latch went
+  char data[PAGE_SIZE];
+  disk_manager.ReadPage(flushed_page_id, data);
+  EXPECT_EQ(0, strcmp(data, "flushed"));
+  EXPECT_EQ(true, bpm.UnpinPage(flushed_page_id, false));
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, SharedCacheTest) {
+  const int num_pages = 30;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  std::string name = SharedPageCache::GetSegmentName("test.db");
+  SharedPageCache::Remove(name);
+  BufferPoolManager bpm(10, &disk_manager);
+  bpm.EnableSharedCache(name, num_pages);
+  EXPECT_EQ(false, bpm.GetSharedCache()->IsAttached());
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), 32, "page-%d", i);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+  }
+
+  // a second pool (as in another process) finds every page written back
+  DiskManager other_disk_manager("test.db");
+  BufferPoolManager other(10, &other_disk_manager);
+  other.EnableSharedCache(name, num_pages);
+  EXPECT_EQ(true, other.GetSharedCache()->IsAttached());
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = other.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page-" + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, other.UnpinPage(i, false));
+  }
+  EXPECT_EQ(static_cast<size_t>(num_pages), other.GetNumSharedHits());
+  EXPECT_EQ(0, other.GetNumSharedMisses());
+
+  // and the new version of a page written by the other one
+  Page *page = other.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  strcpy(page->GetData(), "changed");
+  EXPECT_EQ(true, other.UnpinPage(0, true));
+  EXPECT_EQ(true, other.FlushPage(0));
+  for (int i = 1; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "changed"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+  SharedPageCache::Remove(name);
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, PartitionTest) {
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(20, &disk_manager);
+  BufferPoolPartition *index = bpm.CreatePartition("index", 8);
+  BufferPoolPartition *report = bpm.CreatePartition("report", 0, 4);
+  EXPECT_EQ(index, bpm.CreatePartition("index", 2));
+  EXPECT_EQ(report, bpm.GetPartition("report"));
+  EXPECT_EQ(nullptr, bpm.GetPartition("none"));
+  EXPECT_EQ(2, bpm.GetPartitions().size());
+  EXPECT_EQ(4, report->GetPoolSize());
+  // the minimum shares have to fit into the pool
+  EXPECT_THROW(bpm.CreatePartition("large", 13), Exception);
+
+  std::vector<page_id_t> index_pages, report_pages;
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, index->NewPage(temp_page_id));
+    index_pages.push_back(temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // the report table never gets more than its quota
+  for (int i = 0; i < 40; ++i) {
+    Page *page = report->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), 32, "report %d", i);
+    report_pages.push_back(temp_page_id);
+    EXPECT_EQ(true, report->UnpinPage(temp_page_id, true));
+    EXPECT_GE(4, report->GetNumFrames());
+  }
+  // the rest of the pool cannot take the minimum share of the index
+  for (int i = 0; i < 40; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  EXPECT_EQ(8, index->GetNumFrames());
+  EXPECT_EQ(4, report->GetNumFrames());
+
+  // a scan of the report table misses in its own frames only
+  for (int i = 0; i < 40; ++i) {
+    Page *page = report->FetchPage(report_pages[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(),
+                        ("report " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, report->UnpinPage(report_pages[i], false));
+  }
+  EXPECT_EQ(40, report->GetNumMisses());
+  EXPECT_EQ(0, report->GetNumHits());
+  for (auto page_id : index_pages) {
+    ASSERT_NE(nullptr, index->FetchPage(page_id));
+    EXPECT_EQ(true, index->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(8, index->GetNumHits());
+  EXPECT_EQ(0, index->GetNumMisses());
+  EXPECT_EQ(1.0, index->GetHitRatio());
+
+  // a new partition gets its minimum share from the partitions above theirs
+  BufferPoolPartition *late = bpm.CreatePartition("late", 4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, late->NewPage(temp_page_id));
+    EXPECT_EQ(true, late->UnpinPage(temp_page_id, false));
+  }
+  EXPECT_EQ(4, late->GetNumFrames());
+  EXPECT_EQ(8, index->GetNumFrames());
+  EXPECT_EQ(4, report->GetNumFrames());
+
+  remove("test.db");
+}
+
+// a bad pool option is reported, not thrown through sqlite
+TEST(BufferPoolManagerTest, PoolStatementTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  std::string error;
+  EXPECT_EQ(nullptr, ParsePoolStatement("hot", bpm, error));
+  EXPECT_FALSE(error.empty());
+  error.clear();
+  EXPECT_EQ(nullptr, ParsePoolStatement("hot:ten", bpm, error));
+  EXPECT_FALSE(error.empty());
+  error.clear();
+  EXPECT_EQ(nullptr, ParsePoolStatement("hot:99999999999999999999", bpm,
+                                        error));
+  EXPECT_FALSE(error.empty());
+  error.clear();
+  // more frames than the pool has
+  EXPECT_EQ(nullptr, ParsePoolStatement("hot:100", bpm, error));
+  EXPECT_FALSE(error.empty());
+  error.clear();
+  BufferPool *pool = ParsePoolStatement("hot:10:20", bpm, error);
+  EXPECT_NE(nullptr, pool);
+  EXPECT_TRUE(error.empty());
+  EXPECT_EQ(pool, ParsePoolStatement("hot:10:20", bpm, error));
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, PriorityTest) {
+  page_id_t root_page_id, internal_page_id, temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(10, &disk_manager);
+  ASSERT_NE(nullptr, bpm.NewPage(root_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(root_page_id, true, PagePriority::ROOT));
+  ASSERT_NE(nullptr, bpm.NewPage(internal_page_id));
+  EXPECT_EQ(true,
+            bpm.UnpinPage(internal_page_id, true, PagePriority::INTERNAL));
+
+  // a scan of plain pages cycles through the other frames only
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  size_t misses = bpm.GetNumMisses();
+  // UNCHANGED keeps the priority given before
+  for (auto page_id : {root_page_id, internal_page_id}) {
+    ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(misses, bpm.GetNumMisses());
+
+  // the internal page goes before the root page
+  for (int i = 0; i < 9; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  ASSERT_NE(nullptr, bpm.FetchPage(root_page_id));
+  EXPECT_EQ(misses, bpm.GetNumMisses());
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  ASSERT_NE(nullptr, bpm.FetchPage(internal_page_id));
+  EXPECT_EQ(misses + 1, bpm.GetNumMisses());
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const size_t pool_size = 600;
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(pool_size, &disk_manager);
+
+  // one 4K aligned block, large enough to ask for huge pages
+  FrameArena *arena = bpm.GetArena();
+  EXPECT_EQ(pool_size * bpm.GetPageSize(), arena->GetSize());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena->GetData()) % 4096);
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < pool_size; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % 4096);
+    EXPECT_LE(arena->GetData(), page->GetData());
+    EXPECT_GE(arena->GetData() + arena->GetSize(),
+              page->GetData() + bpm.GetPageSize());
+    pages.push_back(page);
+  }
+
+  // so a frame can be the buffer of an O_DIRECT read
+  snprintf(pages[0]->GetData(), bpm.GetPageSize(), "direct");
+  EXPECT_EQ(true, bpm.UnpinPage(pages[0]->GetPageId(), true));
+  EXPECT_EQ(true, bpm.FlushPage(pages[0]->GetPageId()));
+  int fd = open("test.db", O_RDONLY | O_DIRECT);
+  if (fd >= 0) {
+    EXPECT_EQ(static_cast<ssize_t>(bpm.GetPageSize()),
+              pread(fd, pages[1]->GetData(), bpm.GetPageSize(), 0));
+    EXPECT_EQ(0, strcmp(pages[1]->GetData(), "direct"));
+    close(fd);
+  }
+  for (size_t i = 1; i < pool_size; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(pages[i]->GetPageId(), false));
+  }
+
+  remove("test.db");
+}
+
 } // namespace scudb
@@ -0,0 +1,155 @@
+/**
+ * buffered_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffered_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(BufferedReplacerTest, SampleTest) {
+  BufferedReplacer<int> buffered_replacer(new LRUReplacer<int>(7), 7);
+
+  // push element into replacer
+  buffered_replacer.Insert(1);
+  buffered_replacer.Insert(2);
+  buffered_replacer.Insert(3);
+  buffered_replacer.Insert(4);
+  buffered_replacer.Insert(5);
+  buffered_replacer.Insert(6);
+  buffered_replacer.Insert(1);
+  EXPECT_EQ(6, buffered_replacer.Size());
+
+  // a single thread sees exact LRU order
+  int value;
+  buffered_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  buffered_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  buffered_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, buffered_replacer.Erase(4));
+  EXPECT_EQ(true, buffered_replacer.Erase(6));
+  EXPECT_EQ(2, buffered_replacer.Size());
+
+  // pop element from replacer after removal
+  buffered_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  buffered_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(false, buffered_replacer.Victim(value));
+}
+
+TEST(BufferedReplacerTest, BatchTest) {
+  const int num_frames = 200;
+  BufferedReplacer<int> buffered_replacer(new LRUReplacer<int>(num_frames),
+                                          num_frames);
+
+  // more accesses than a stripe holds, part of them is applied early
+  int value;
+  for (int i = 0; i < num_frames; ++i) {
+    buffered_replacer.Insert(i);
+  }
+  // pinned after the access was recorded: never handed out
+  for (int i = 0; i < num_frames; i += 2) {
+    EXPECT_EQ(true, buffered_replacer.Erase(i));
+  }
+  for (int i = 1; i < num_frames; i += 2) {
+    EXPECT_EQ(true, buffered_replacer.Victim(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(false, buffered_replacer.Victim(value));
+
+  // unpinned again, evictable in the new order
+  buffered_replacer.Insert(4);
+  buffered_replacer.Insert(2);
+  buffered_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  buffered_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+}
+
+// the wrapped policy learns about pins, it never evicts a pinned frame and
+// keeps what it knows about it
+TEST(BufferedReplacerTest, PinnedFrameTest) {
+  // LRU-K: 0 has the oldest 2nd last access when it is pinned
+  BufferedReplacer<int> lru_k(new LRUKReplacer<int>(3, 2), 3);
+  lru_k.Insert(0);
+  lru_k.Insert(1);
+  lru_k.Insert(1);
+  lru_k.Insert(2);
+  lru_k.Insert(2);
+  lru_k.Insert(0);
+  EXPECT_EQ(true, lru_k.Erase(0));
+  int value;
+  EXPECT_EQ(true, lru_k.Victim(value));
+  EXPECT_EQ(1, value);
+  // unpinned, 0 still has its history: its 2nd last access is now the
+  // latest one
+  lru_k.Insert(0);
+  EXPECT_EQ(true, lru_k.Victim(value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(true, lru_k.Victim(value));
+  EXPECT_EQ(0, value);
+
+  // ARC: a pinned frame stays resident, it does not come back as a ghost hit
+  ARCReplacer<int> *arc = new ARCReplacer<int>(4);
+  BufferedReplacer<int> buffered_arc(arc, 4);
+  for (int i = 0; i < 4; ++i)
+    buffered_arc.Insert(i);
+  EXPECT_EQ(true, buffered_arc.Erase(0));
+  EXPECT_EQ(true, buffered_arc.Victim(value));
+  EXPECT_EQ(1, value);
+  buffered_arc.Insert(0);
+  EXPECT_EQ(true, buffered_arc.Victim(value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(0, arc->GetTargetRecencySize());
+  EXPECT_EQ(2, arc->Size());
+}
+
+TEST(BufferedReplacerTest, ConcurrentTest) {
+  const int num_threads = 4;
+  const int num_frames = 64;
+  BufferedReplacer<int> buffered_replacer(new LRUReplacer<int>(num_frames),
+                                          num_frames);
+
+  // each thread keeps toggling its own frames in and out of the replacer
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 1000; ++round) {
+        for (int i = t; i < num_frames; i += num_threads) {
+          buffered_replacer.Insert(i);
+        }
+        for (int i = t; i < num_frames; i += 2 * num_threads) {
+          buffered_replacer.Erase(i);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  // every thread left exactly half of its frames evictable
+  EXPECT_EQ(num_frames / 2, buffered_replacer.Size());
+  int value;
+  std::vector<bool> seen(num_frames, false);
+  while (buffered_replacer.Victim(value)) {
+    EXPECT_EQ(false, seen[value]);
+    // the erased half is i % 8 < 4
+    EXPECT_LE(num_threads, value % (2 * num_threads));
+    seen[value] = true;
+  }
+  EXPECT_EQ(0, buffered_replacer.Size());
+}
+
+} // namespace scudb
@@ -0,0 +1,115 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer(7);
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // first sweep clears every reference bit, the second evicts in slot order
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+
+  // a referenced frame gets a second chance
+  clock_replacer.Insert(4);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(3));
+  EXPECT_EQ(true, clock_replacer.Erase(6));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // pop element from replacer after removal
+  clock_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+}
+
+TEST(ClockReplacerTest, ConcurrentTest) {
+  const int num_threads = 4;
+  const int num_frames = 64;
+  ClockReplacer<int> clock_replacer(num_frames);
+
+  // each thread keeps toggling its own frames in and out of the replacer
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 1000; ++round) {
+        for (int i = t; i < num_frames; i += num_threads) {
+          clock_replacer.Insert(i);
+        }
+        for (int i = t; i < num_frames; i += 2 * num_threads) {
+          clock_replacer.Erase(i);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  // every thread left exactly half of its frames evictable
+  EXPECT_EQ(num_frames / 2, clock_replacer.Size());
+  int value;
+  std::vector<bool> seen(num_frames, false);
+  while (clock_replacer.Victim(value)) {
+    EXPECT_EQ(false, seen[value]);
+    seen[value] = true;
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, BufferPoolTest) {
+  page_id_t temp_page_id;
+
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(3, &disk_manager, nullptr, ReplacerType::CLOCK);
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  EXPECT_EQ(0, temp_page_id);
+  strcpy(page_zero->GetData(), "Hello");
+  EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // page 0 is the first frame under the hand once the bits are cleared
+  EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace scudb
@@ -0,0 +1,107 @@
+/**
+ * compressed_cache_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "buffer/compressed_cache.h"
+#include "buffer/page_compressor.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// a table page like content: small ints and short strings, zeros elsewhere
+static void FillPage(char *data, size_t size, int seed) {
+  memset(data, 0, size);
+  for (size_t offset = 0; offset + 32 <= size / 2; offset += 32) {
+    snprintf(data + offset, 32, "row %d name-%d", seed, static_cast<int>(offset));
+  }
+}
+
+TEST(CompressedCacheTest, CodecTest) {
+  const size_t size = 4096;
+  std::vector<char> page(size), compressed(size), output(size);
+
+  // zeros, repeated rows and random bytes all come back the same
+  std::mt19937 generator(0);
+  for (int kind = 0; kind < 3; ++kind) {
+    if (kind == 0)
+      memset(page.data(), 0, size);
+    else if (kind == 1)
+      FillPage(page.data(), size, 7);
+    else
+      for (auto &byte : page)
+        byte = static_cast<char>(generator());
+    size_t compressed_size =
+        PageCompressor::Compress(page.data(), size, compressed.data(), size);
+    if (kind < 2) {
+      EXPECT_LT(0, compressed_size);
+      EXPECT_GT(size / 4, compressed_size);
+    }
+    if (compressed_size > 0) {
+      EXPECT_EQ(true, PageCompressor::Decompress(compressed.data(),
+                                                 compressed_size,
+                                                 output.data(), size));
+      EXPECT_EQ(0, memcmp(page.data(), output.data(), size));
+    }
+  }
+
+  // random bytes do not fit into less than the page
+  EXPECT_EQ(0, PageCompressor::Compress(page.data(), size, compressed.data(),
+                                        size - size / 8));
+  // corrupt input is refused
+  FillPage(page.data(), size, 1);
+  size_t compressed_size =
+      PageCompressor::Compress(page.data(), size, compressed.data(), size);
+  EXPECT_EQ(false, PageCompressor::Decompress(compressed.data(),
+                                              compressed_size / 2,
+                                              output.data(), size));
+}
+
+TEST(CompressedCacheTest, BudgetTest) {
+  const size_t size = 4096;
+  std::vector<char> page(size), output(size);
+  CompressedCache cache(4 * size, size);
+
+  FillPage(page.data(), size, 0);
+  EXPECT_EQ(true, cache.Put(0, page.data()));
+  EXPECT_EQ(1, cache.GetNumPages());
+  EXPECT_GT(size, cache.GetMemoryUsage());
+
+  // a hit moves the page out of the tier
+  EXPECT_EQ(true, cache.Get(0, output.data()));
+  EXPECT_EQ(0, memcmp(page.data(), output.data(), size));
+  EXPECT_EQ(false, cache.Get(0, output.data()));
+  EXPECT_EQ(1, cache.GetNumHits());
+  EXPECT_EQ(1, cache.GetNumMisses());
+  EXPECT_EQ(0, cache.GetMemoryUsage());
+
+  // many pages compressed fit into a budget of a few, the oldest go first
+  int num_pages = 0;
+  for (page_id_t page_id = 0; page_id < 100; ++page_id) {
+    FillPage(page.data(), size, page_id);
+    EXPECT_EQ(true, cache.Put(page_id, page.data()));
+  }
+  num_pages = cache.GetNumPages();
+  EXPECT_LT(4, num_pages);
+  EXPECT_EQ(100 - num_pages, cache.GetNumEvictions());
+  EXPECT_GE(cache.GetBudget(), cache.GetMemoryUsage());
+  EXPECT_EQ(false, cache.Get(0, output.data()));
+  EXPECT_EQ(true, cache.Get(99, output.data()));
+  FillPage(page.data(), size, 99);
+  EXPECT_EQ(0, memcmp(page.data(), output.data(), size));
+
+  // pages that do not compress are not kept, erased ones are gone
+  std::mt19937 generator(0);
+  for (auto &byte : page)
+    byte = static_cast<char>(generator());
+  EXPECT_EQ(false, cache.Put(200, page.data()));
+  EXPECT_EQ(1, cache.GetNumRejected());
+  cache.Erase(98);
+  EXPECT_EQ(false, cache.Get(98, output.data()));
+}
+
+} // namespace scudb
@@ -0,0 +1,105 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(7, 2);
+
+  // push element into replacer, only 1 and 2 are accessed twice
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(4);
+  lru_k_replacer.Insert(5);
+  lru_k_replacer.Insert(6);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // pages with a single access are infinitely old and go first, LRU order
+  int value;
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, lru_k_replacer.Erase(4));
+  EXPECT_EQ(true, lru_k_replacer.Erase(5));
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(6, value);
+  // 1 and 2 have two accesses, 1's second last access is the older one
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+
+  // a victimized frame forgets its history
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const int num_frames = 10;
+  LRUKReplacer<int> lru_k_replacer(num_frames);
+
+  // frames 0 and 1 hold hot pages touched by every query
+  for (int i = 0; i < 3; ++i) {
+    lru_k_replacer.Erase(0);
+    lru_k_replacer.Insert(0);
+    lru_k_replacer.Erase(1);
+    lru_k_replacer.Insert(1);
+  }
+  // a long scan keeps cycling the other frames
+  int value;
+  for (int i = 2; i < num_frames; ++i) {
+    lru_k_replacer.Insert(i);
+  }
+  for (int round = 0; round < 100; ++round) {
+    ASSERT_EQ(true, lru_k_replacer.Victim(value));
+    EXPECT_NE(0, value);
+    EXPECT_NE(1, value);
+    lru_k_replacer.Insert(value);
+  }
+  EXPECT_EQ(num_frames, lru_k_replacer.Size());
+}
+
+// a frame that gets another page without being a victim, e.g. after
+// DeletePage, does not keep the history of the old one
+TEST(LRUKReplacerTest, ResetTest) {
+  LRUKReplacer<int> lru_k_replacer(3);
+  int value;
+  for (int i = 0; i < 3; ++i) {
+    lru_k_replacer.Insert(0);
+    lru_k_replacer.Insert(1);
+  }
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(2);
+  // frame 0 was freed and holds a new page
+  EXPECT_EQ(true, lru_k_replacer.Erase(0));
+  lru_k_replacer.Reset(0);
+  lru_k_replacer.Insert(0);
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(0, value);
+  // a reset frame is not evictable until it is inserted again
+  lru_k_replacer.Reset(1);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+}
+
+} // namespace scudb
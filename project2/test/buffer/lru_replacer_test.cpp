@@ -3,6 +3,7 @@
  */
 
 #include <cstdio>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
@@ -10,7 +11,7 @@
 namespace scudb {
 
 TEST(LRUReplacerTest, SampleTest) {
-  LRUReplacer<int> lru_replacer;
+  LRUReplacer<int> lru_replacer(7);
   
   // push element into replacer
   lru_replacer.Insert(1);
@@ -43,4 +44,48 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(1, value);
 }
 
+TEST(LRUReplacerTest, PeekVictimsTest) {
+  LRUReplacer<int> lru_replacer(7);
+  lru_replacer.Insert(3);
+  lru_replacer.Insert(1);
+  lru_replacer.Insert(2);
+  lru_replacer.Insert(3);
+
+  // least recently used first, nothing is evicted
+  std::vector<int> values;
+  EXPECT_EQ(true, lru_replacer.PeekVictims(values, 2));
+  EXPECT_EQ(std::vector<int>({1, 2}), values);
+  EXPECT_EQ(3, lru_replacer.Size());
+  int value;
+  lru_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUReplacerTest, FrameReuseTest) {
+  const int num_frames = 16;
+  LRUReplacer<int> lru_replacer(num_frames);
+
+  // frames cycle through the list many times, order stays least recent first
+  int value;
+  for (int i = 0; i < num_frames; ++i) {
+    lru_replacer.Insert(i);
+  }
+  for (int round = 0; round < 64 * num_frames; ++round) {
+    EXPECT_EQ(true, lru_replacer.Victim(value));
+    EXPECT_EQ(round % num_frames, value);
+    lru_replacer.Insert(value);
+  }
+  EXPECT_EQ(num_frames, lru_replacer.Size());
+
+  // erase every other frame, the rest keep their order
+  for (int i = 0; i < num_frames; i += 2) {
+    EXPECT_EQ(true, lru_replacer.Erase(i));
+  }
+  for (int i = 1; i < num_frames; i += 2) {
+    EXPECT_EQ(true, lru_replacer.Victim(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(false, lru_replacer.Victim(value));
+}
+
 } // namespace scudb
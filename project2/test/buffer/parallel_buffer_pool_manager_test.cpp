@@ -0,0 +1,217 @@
+/**
+ * parallel_buffer_pool_manager_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_partition.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  page_id_t temp_page_id;
+
+  DiskManager disk_manager("test.db");
+  // 5 instances of 2 frames each
+  ParallelBufferPoolManager bpm(5, 10, &disk_manager);
+  EXPECT_EQ(5, bpm.GetNumInstances());
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, temp_page_id);
+  strcpy(page_zero->GetData(), "Hello");
+
+  // page ids are spread round robin, so all ten frames can be filled
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(i, temp_page_id);
+  }
+  // every instance is full, id 10 is given back and tried again
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  }
+  // unpin pages 0..4, one evictable frame per instance
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  EXPECT_EQ(false, bpm.UnpinPage(0, false));
+
+  // page 10 lives in the same instance as page 0 and evicts it
+  EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(10, temp_page_id);
+  // that instance now holds pinned pages 5 and 10 only
+  EXPECT_EQ(nullptr, bpm.FetchPage(0));
+  EXPECT_EQ(true, bpm.UnpinPage(10, false));
+
+  // fetch page zero again, it was written back when evicted
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 20;
+  DiskManager disk_manager("test.db");
+  ParallelBufferPoolManager bpm(4, 16, &disk_manager);
+
+  // every thread creates its own pages and writes its thread id into them
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id;
+        Page *page = bpm.NewPage(page_id);
+        while (page == nullptr) {
+          std::this_thread::yield();
+          page = bpm.NewPage(page_id);
+        }
+        snprintf(page->GetData(), PAGE_SIZE, "%d-%d", t, i);
+        page_ids[t].push_back(page_id);
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  threads.clear();
+
+  // read everything back concurrently, most of it has been evicted by now
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      char expected[32];
+      for (int i = 0; i < pages_per_thread; ++i) {
+        Page *page = bpm.FetchPage(page_ids[t][i]);
+        while (page == nullptr) {
+          std::this_thread::yield();
+          page = bpm.FetchPage(page_ids[t][i]);
+        }
+        snprintf(expected, sizeof(expected), "%d-%d", t, i);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm.UnpinPage(page_ids[t][i], false));
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  ParallelBufferPoolManager bpm(4, 8, &disk_manager, nullptr,
+                                ReplacerType::LRU, 32);
+  EXPECT_EQ(32, bpm.GetMaxPoolSize());
+
+  // every instance takes its share
+  bpm.Resize(32);
+  EXPECT_EQ(32, bpm.GetPoolSize());
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  for (page_id_t page_id = 0; page_id < 32; ++page_id) {
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+  }
+  bpm.Resize(6);
+  EXPECT_EQ(6, bpm.GetPoolSize());
+  EXPECT_EQ(0, bpm.GetNumForegroundWrites());
+
+  remove("test.db");
+}
+
+TEST(ParallelBufferPoolManagerTest, PartitionTest) {
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  // 2 instances of 10 frames each
+  ParallelBufferPoolManager bpm(2, 20, &disk_manager);
+  BufferPoolPartition *report = bpm.CreatePartition("report", 0, 4);
+  ASSERT_NE(nullptr, report);
+  EXPECT_EQ(report, bpm.CreatePartition("report", 2));
+  EXPECT_EQ(report, bpm.GetPartition("report"));
+  EXPECT_EQ(1, bpm.GetPartitions().size());
+  EXPECT_EQ(4, report->GetPoolSize());
+  // every instance has its share of the partition
+  for (size_t i = 0; i < bpm.GetNumInstances(); ++i) {
+    BufferPoolPartition *share = bpm.GetInstanceAt(i)->GetPartition("report");
+    ASSERT_NE(nullptr, share);
+    EXPECT_EQ(2, share->GetMaxFrames());
+  }
+
+  // the pages go to the partition's frames in both instances, within quota
+  std::vector<page_id_t> report_pages;
+  for (int i = 0; i < 20; ++i) {
+    Page *page = report->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), 32, "report %d", i);
+    report_pages.push_back(temp_page_id);
+    EXPECT_EQ(true, report->UnpinPage(temp_page_id, true));
+    EXPECT_GE(4, report->GetNumFrames());
+  }
+  EXPECT_EQ(4, report->GetNumFrames());
+  for (int i = 0; i < 20; ++i) {
+    Page *page = report->FetchPage(report_pages[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(),
+                        ("report " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, report->UnpinPage(report_pages[i], false));
+  }
+  EXPECT_EQ(20, report->GetNumMisses());
+  EXPECT_EQ(0, report->GetNumHits());
+  EXPECT_EQ(4, report->GetNumFrames());
+
+  // the settings reach every instance
+  bpm.EnableCompressedCache(20 * bpm.GetPageSize());
+  bpm.SetPrefetchWindow(3);
+  for (size_t i = 0; i < bpm.GetNumInstances(); ++i) {
+    EXPECT_NE(nullptr, bpm.GetInstanceAt(i)->GetCompressedCache());
+    EXPECT_EQ(3, bpm.GetInstanceAt(i)->GetPrefetchWindow());
+  }
+
+  remove("test.db");
+}
+
+TEST(ParallelBufferPoolManagerTest, WarmUpTest) {
+  page_id_t temp_page_id;
+  DiskManager disk_manager("test.db");
+  {
+    ParallelBufferPoolManager bpm(2, 8, &disk_manager);
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+      EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+    }
+    // the image of both instances is saved when the writers stop
+    bpm.SetWarmImageFile("test.warm");
+    bpm.RunWriterThread();
+    bpm.StopWriterThread();
+  }
+
+  // every page is loaded into its instance
+  ParallelBufferPoolManager bpm(2, 8, &disk_manager);
+  EXPECT_EQ(8, bpm.WarmUp("test.warm"));
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    EXPECT_NE(nullptr, bpm.FetchPage(page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(8, bpm.GetNumHits());
+  EXPECT_EQ(0, bpm.GetNumMisses());
+
+  remove("test.db");
+  remove("test.warm");
+}
+
+} // namespace scudb
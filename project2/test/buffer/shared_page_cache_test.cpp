@@ -0,0 +1,105 @@
+/**
+ * shared_page_cache_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "buffer/shared_page_cache.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(SharedPageCacheTest, CacheTest) {
+  const size_t size = 4096;
+  std::ofstream("test.db").close();
+  std::string name = SharedPageCache::GetSegmentName("test.db");
+  SharedPageCache::Remove(name);
+  std::vector<char> page(size), output(size);
+  {
+    SharedPageCache cache(name, 8, size, "test.db");
+    EXPECT_EQ(false, cache.IsAttached());
+    EXPECT_EQ(8, cache.GetNumSlots());
+    for (int i = 0; i < 9; ++i) {
+      snprintf(page.data(), size, "page %d", i);
+      cache.Put(i, page.data());
+    }
+    EXPECT_EQ(8, cache.GetNumPages());
+    // the clock keeps the page read again, new ones replace the others
+    EXPECT_EQ(true, cache.Get(3, output.data()));
+    EXPECT_EQ(0, strcmp(output.data(), "page 3"));
+    for (int i = 9; i < 15; ++i) {
+      snprintf(page.data(), size, "page %d", i);
+      cache.Put(i, page.data());
+    }
+    EXPECT_EQ(8, cache.GetNumPages());
+    EXPECT_EQ(true, cache.Get(3, output.data()));
+    EXPECT_EQ(false, cache.Get(0, output.data()));
+    cache.Erase(3);
+    EXPECT_EQ(false, cache.Get(3, output.data()));
+    EXPECT_EQ(2, cache.GetNumHits());
+    EXPECT_EQ(2, cache.GetNumMisses());
+
+    // a second user attaches to the pages, whatever size it asks for
+    SharedPageCache other(name, 100, size, "test.db");
+    EXPECT_EQ(true, other.IsAttached());
+    EXPECT_EQ(8, other.GetNumSlots());
+    EXPECT_EQ(true, other.Get(14, output.data()));
+    EXPECT_EQ(0, strcmp(output.data(), "page 14"));
+  }
+
+  // the segment outlives its users, but not a new file of the same name
+  {
+    SharedPageCache cache(name, 8, size, "test.db");
+    EXPECT_EQ(true, cache.IsAttached());
+    EXPECT_EQ(7, cache.GetNumPages());
+  }
+  std::ofstream("test_new.db").close();
+  rename("test_new.db", "test.db");
+  {
+    SharedPageCache cache(name, 8, size, "test.db");
+    EXPECT_EQ(0, cache.GetNumPages());
+  }
+  SharedPageCache::Remove(name);
+  remove("test.db");
+}
+
+TEST(SharedPageCacheTest, ProcessTest) {
+  const size_t size = 4096;
+  std::ofstream("test.db").close();
+  std::string name = SharedPageCache::GetSegmentName("test.db");
+  SharedPageCache::Remove(name);
+
+  // a process that has exited leaves its pages for the next one
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    SharedPageCache cache(name, 16, size, "test.db");
+    std::vector<char> page(size);
+    for (int i = 0; i < 16; ++i) {
+      snprintf(page.data(), size, "page %d", i);
+      cache.Put(i, page.data());
+    }
+    _exit(0);
+  }
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  EXPECT_EQ(0, status);
+
+  SharedPageCache cache(name, 16, size, "test.db");
+  EXPECT_EQ(true, cache.IsAttached());
+  std::vector<char> output(size);
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(true, cache.Get(i, output.data()));
+    EXPECT_EQ(0, strcmp(output.data(), ("page " + std::to_string(i)).c_str()));
+  }
+  SharedPageCache::Remove(name);
+  remove("test.db");
+}
+
+} // namespace scudb
@@ -0,0 +1,366 @@
+/**
+ * disk_manager_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common/exception.h"
+#include "disk/disk_manager.h"
+#include "disk/extent.h"
+#include "disk/io_uring_io.h"
+#include "disk/thread_pool_io.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  const int num_pages = num_threads * pages_per_thread;
+  {
+    DiskManager disk_manager("test.db");
+    size_t page_size = disk_manager.GetPageSize();
+    // every thread writes its own pages, there is no shared file position
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.push_back(std::thread([&, t] {
+        std::vector<char> page(page_size);
+        for (int i = t; i < num_pages; i += num_threads) {
+          snprintf(page.data(), page_size, "page %d", i);
+          disk_manager.WritePage(i, page.data());
+        }
+      }));
+    }
+    for (auto &thread : threads)
+      thread.join();
+    disk_manager.Sync();
+
+    // a page past the end of the file reads as zeros
+    std::vector<char> page(page_size, 'x');
+    disk_manager.ReadPage(num_pages + 1, page.data());
+    EXPECT_EQ(std::vector<char>(page_size, 0), page);
+  }
+
+  // and everything is there after a reopen
+  DiskManager disk_manager("test.db");
+  size_t page_size = disk_manager.GetPageSize();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.push_back(std::thread([&, t] {
+      std::vector<char> page(page_size);
+      for (int i = 0; i < num_pages; ++i) {
+        int page_id = (i + t * pages_per_thread) % num_pages;
+        disk_manager.ReadPage(page_id, page.data());
+        EXPECT_EQ(0, strcmp(page.data(),
+                            ("page " + std::to_string(page_id)).c_str()));
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  std::vector<char> pages(4 * page_size);
+  EXPECT_EQ(2, disk_manager.ReadPages(num_pages - 2, 4, pages.data()));
+  EXPECT_EQ(0, strcmp(pages.data() + page_size,
+                      ("page " + std::to_string(num_pages - 1)).c_str()));
+  EXPECT_EQ(0, pages[2 * page_size]);
+  remove("test.db");
+  remove("test.log");
+}
+
+// what HeaderPage::Init writes at the start of the header page
+static void WriteHeaderPage(DiskManager *disk_manager, uint32_t flags) {
+  std::vector<char> page(disk_manager->GetPageSize());
+  uint32_t format[3] = {DB_FORMAT_MAGIC,
+                        static_cast<uint32_t>(disk_manager->GetPageSize()),
+                        flags};
+  memcpy(page.data(), format, sizeof(format));
+  disk_manager->WritePage(HEADER_PAGE_ID, page.data());
+}
+
+TEST(DiskManagerTest, SpaceMapTest) {
+  {
+    DiskManager disk_manager("test.db");
+    for (page_id_t i = 0; i < 10; ++i)
+      EXPECT_EQ(i, disk_manager.AllocatePage());
+    // freed pages come back lowest first, the header page never
+    disk_manager.DeallocatePage(7);
+    disk_manager.DeallocatePage(3);
+    disk_manager.DeallocatePage(HEADER_PAGE_ID);
+    disk_manager.DeallocatePage(3);
+    EXPECT_EQ(2, disk_manager.GetNumFreePages());
+    EXPECT_EQ(3, disk_manager.AllocatePage());
+    EXPECT_EQ(7, disk_manager.AllocatePage());
+    EXPECT_EQ(10, disk_manager.AllocatePage());
+
+    // the last page of a group holds its space map
+    page_id_t page_id = 0;
+    while (page_id < SPACE_MAP_GROUP_PAGES)
+      page_id = disk_manager.AllocatePage();
+    EXPECT_EQ(SPACE_MAP_GROUP_PAGES, page_id);
+    std::vector<char> page(disk_manager.GetPageSize());
+    for (page_id_t i = 0; i <= page_id; ++i) {
+      if (i != SPACE_MAP_GROUP_PAGES - 1)
+        disk_manager.WritePage(i, page.data());
+    }
+    WriteHeaderPage(&disk_manager, DB_FORMAT_SPACE_MAPS);
+    disk_manager.DeallocatePage(5);
+    disk_manager.DeallocatePage(page_id);
+  }
+
+  // the allocator state comes back from the file
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(SPACE_MAP_GROUP_PAGES + 1, disk_manager.GetNextPageId());
+    EXPECT_EQ(2, disk_manager.GetNumFreePages());
+    EXPECT_EQ(5, disk_manager.AllocatePage());
+    EXPECT_EQ(SPACE_MAP_GROUP_PAGES, disk_manager.AllocatePage());
+    EXPECT_EQ(SPACE_MAP_GROUP_PAGES + 1, disk_manager.AllocatePage());
+    disk_manager.DeallocatePage(9);
+  }
+  // also when the file ends with a space map page
+  remove("test.db");
+  {
+    DiskManager disk_manager("test.db");
+    std::vector<char> page(disk_manager.GetPageSize());
+    for (page_id_t i = 0; i < 20; ++i)
+      disk_manager.WritePage(disk_manager.AllocatePage(), page.data());
+    WriteHeaderPage(&disk_manager, DB_FORMAT_SPACE_MAPS);
+    disk_manager.DeallocatePage(12);
+    EXPECT_EQ(12, disk_manager.AllocatePage());
+    EXPECT_EQ(20, disk_manager.AllocatePage());
+    disk_manager.DeallocatePage(15);
+  }
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(21, disk_manager.GetNextPageId());
+    EXPECT_EQ(15, disk_manager.AllocatePage());
+    EXPECT_EQ(21, disk_manager.AllocatePage());
+  }
+  remove("test.db");
+
+  // a file created without space maps may hold a zeroed data page where a
+  // map would go: it is left alone, and freed pages are not reused
+  {
+    DiskManager disk_manager("test.db");
+    std::vector<char> page(disk_manager.GetPageSize());
+    for (page_id_t i = 0; i < SPACE_MAP_GROUP_PAGES; ++i)
+      disk_manager.WritePage(i, page.data());
+    WriteHeaderPage(&disk_manager, 0);
+  }
+  {
+    DiskManager disk_manager("test.db");
+    disk_manager.DeallocatePage(5);
+    EXPECT_EQ(0, disk_manager.GetNumFreePages());
+    EXPECT_EQ(SPACE_MAP_GROUP_PAGES, disk_manager.AllocatePage());
+    std::vector<char> page(disk_manager.GetPageSize(), 1);
+    disk_manager.ReadPage(SPACE_MAP_GROUP_PAGES - 1, page.data());
+    EXPECT_EQ(page.end(), std::find_if(page.begin(), page.end(),
+                                       [](char c) { return c != 0; }));
+  }
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, ExtentTest) {
+  DiskManager disk_manager("test.db");
+  EXPECT_EQ(0, disk_manager.AllocatePage());
+  EXPECT_EQ(1, disk_manager.AllocatePage());
+  int num_pages = 64;
+  EXPECT_EQ(2, disk_manager.AllocateExtent(num_pages));
+  EXPECT_EQ(64, num_pages);
+  EXPECT_EQ(66, disk_manager.AllocatePage());
+
+  // a run in between becomes free pages, and comes back as a whole
+  disk_manager.DeallocateExtent(2, 64);
+  EXPECT_EQ(64, disk_manager.GetNumFreePages());
+  num_pages = 32;
+  EXPECT_EQ(2, disk_manager.AllocateExtent(num_pages));
+  EXPECT_EQ(32, disk_manager.GetNumFreePages());
+  // too few free pages left for the next one, it is taken past the used ones
+  num_pages = 64;
+  EXPECT_EQ(67, disk_manager.AllocateExtent(num_pages));
+  // a run at the end is simply not used
+  disk_manager.DeallocateExtent(67, 64);
+  EXPECT_EQ(67, disk_manager.GetNextPageId());
+  EXPECT_EQ(32, disk_manager.GetNumFreePages());
+
+  // runs stop short of a space map page
+  page_id_t end_page_id = 67;
+  while (end_page_id < SPACE_MAP_GROUP_PAGES - 1) {
+    num_pages = 64;
+    EXPECT_EQ(end_page_id, disk_manager.AllocateExtent(num_pages));
+    end_page_id += num_pages;
+  }
+  EXPECT_EQ(SPACE_MAP_GROUP_PAGES - 1, end_page_id);
+  num_pages = 64;
+  EXPECT_EQ(SPACE_MAP_GROUP_PAGES, disk_manager.AllocateExtent(num_pages));
+  EXPECT_EQ(64, num_pages);
+
+  // an extent hands out its run in order, here one of the free pages
+  Extent extent(4);
+  page_id_t first_page_id = extent.AllocatePage(&disk_manager);
+  EXPECT_EQ(34, first_page_id);
+  EXPECT_EQ(28, disk_manager.GetNumFreePages());
+  EXPECT_EQ(first_page_id + 1, extent.AllocatePage(&disk_manager));
+  extent.DeallocatePage(first_page_id + 1);
+  EXPECT_EQ(first_page_id + 1, extent.AllocatePage(&disk_manager));
+  EXPECT_EQ(2, extent.GetNumFreePages());
+  extent.Release();
+  EXPECT_EQ(30, disk_manager.GetNumFreePages());
+  EXPECT_EQ(SPACE_MAP_GROUP_PAGES + 64, disk_manager.GetNextPageId());
+  remove("test.db");
+  remove("test.log");
+}
+
+// random page reads per second with num_threads reads in flight
+static double ReadsPerSecond(DiskManager *disk_manager, int num_pages,
+                             int num_threads) {
+  const int reads_per_thread = 20000;
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.push_back(std::thread([=] {
+      std::mt19937 generator(t);
+      std::vector<char> page(disk_manager->GetPageSize());
+      for (int i = 0; i < reads_per_thread; ++i)
+        disk_manager->ReadPage(generator() % num_pages, page.data());
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return num_threads * reads_per_thread / elapsed.count();
+}
+
+TEST(DiskManagerTest, RandomReadBenchmark) {
+  const int num_pages = 2048;
+  DiskManager disk_manager("test.db");
+  std::vector<char> page(disk_manager.GetPageSize());
+  for (int i = 0; i < num_pages; ++i) {
+    snprintf(page.data(), page.size(), "page %d", i);
+    disk_manager.WritePage(i, page.data());
+  }
+  disk_manager.Sync();
+
+  printf("queue depth   reads/s\n");
+  for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+    printf("%11d %9.0f\n", num_threads,
+           ReadsPerSecond(&disk_manager, num_pages, num_threads));
+  }
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, AsyncReadWriteTest) {
+  const int num_pages = 256;
+  DiskManager disk_manager("test.db");
+  size_t page_size = disk_manager.GetPageSize();
+  std::vector<char> pages(num_pages * page_size);
+  std::vector<std::future<void>> writes;
+  for (int i = 0; i < num_pages; ++i) {
+    snprintf(pages.data() + i * page_size, page_size, "page %d", i);
+    writes.push_back(
+        disk_manager.WritePageAsync(i, pages.data() + i * page_size));
+  }
+  for (auto &write : writes)
+    write.wait();
+
+  // reads in flight together, in any order
+  std::vector<char> output(num_pages * page_size, 'x');
+  std::vector<std::future<void>> reads;
+  for (int i = num_pages - 1; i >= 0; --i)
+    reads.push_back(
+        disk_manager.ReadPageAsync(i, output.data() + i * page_size));
+  for (auto &read : reads)
+    read.wait();
+  EXPECT_EQ(pages, output);
+
+  // a read across the end of the file fills the rest with zeros
+  std::vector<char> tail(4 * page_size, 'x');
+  EXPECT_EQ(2, disk_manager.ReadPagesAsync(num_pages - 2, 4, tail.data()).get());
+  EXPECT_EQ(0, strcmp(tail.data() + page_size,
+                      ("page " + std::to_string(num_pages - 1)).c_str()));
+  EXPECT_EQ(0, tail[2 * page_size]);
+  EXPECT_EQ(0, tail[4 * page_size - 1]);
+  remove("test.db");
+  remove("test.log");
+}
+
+// random page reads per second with queue_depth of them in flight, all
+// submitted from one thread
+static double AsyncReadsPerSecond(AsyncIO *async_io, int fd, int num_pages,
+                                  size_t page_size, size_t queue_depth) {
+  const int num_reads = 20000;
+  std::mt19937 generator(0);
+  std::vector<char> buffers(queue_depth * page_size);
+  std::mutex latch;
+  std::condition_variable done_cv;
+  int num_done = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_reads; ++i) {
+    // Submit waits for a free slot, a buffer is reused queue_depth reads on
+    async_io->Submit(IOOp::READ, fd,
+                     buffers.data() + (i % queue_depth) * page_size, page_size,
+                     static_cast<off_t>(generator() % num_pages) * page_size,
+                     [&](ssize_t) {
+                       std::lock_guard<std::mutex> lck(latch);
+                       num_done++;
+                       done_cv.notify_one();
+                     });
+  }
+  std::unique_lock<std::mutex> lck(latch);
+  done_cv.wait(lck, [&] { return num_done == num_reads; });
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return num_reads / elapsed.count();
+}
+
+TEST(DiskManagerTest, AsyncReadBenchmark) {
+  const int num_pages = 2048;
+  const size_t page_size = PAGE_SIZE;
+  {
+    DiskManager disk_manager("test.db");
+    std::vector<char> page(page_size);
+    for (int i = 0; i < num_pages; ++i) {
+      snprintf(page.data(), page.size(), "page %d", i);
+      disk_manager.WritePage(i, page.data());
+    }
+  }
+  int fd = open("test.db", O_RDONLY);
+  ASSERT_LE(0, fd);
+
+  printf("queue depth   io_uring IOPS   thread pool IOPS\n");
+  for (size_t queue_depth = 1; queue_depth <= 64; queue_depth *= 2) {
+    double uring = 0;
+    try {
+      IOUringIO async_io(queue_depth);
+      uring = AsyncReadsPerSecond(&async_io, fd, num_pages, page_size,
+                                  queue_depth);
+    } catch (Exception &) {
+      // no io_uring here
+    }
+    ThreadPoolIO thread_pool(queue_depth,
+                             std::min<size_t>(queue_depth, DISK_IO_THREADS));
+    double pool = AsyncReadsPerSecond(&thread_pool, fd, num_pages, page_size,
+                                      queue_depth);
+    printf("%11zu %15.0f %18.0f\n", queue_depth, uring, pool);
+  }
+  close(fd);
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace scudb
@@ -0,0 +1,204 @@
+/**
+ * page_table_test.cpp
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "hash/extendible_hash.h"
+#include "hash/page_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable<int> *test = new PageTable<int>(8);
+
+  // insert several key/value pairs
+  for (int i = 1; i <= 8; ++i) {
+    test->Insert(i, i * 10);
+  }
+  EXPECT_EQ(8, test->Size());
+
+  // find test
+  int result = 0;
+  EXPECT_EQ(1, test->Find(8, result));
+  EXPECT_EQ(80, result);
+  EXPECT_EQ(1, test->Find(1, result));
+  EXPECT_EQ(10, result);
+  EXPECT_EQ(0, test->Find(9, result));
+
+  // insert of a present key replaces its value
+  test->Insert(3, 33);
+  EXPECT_EQ(1, test->Find(3, result));
+  EXPECT_EQ(33, result);
+  EXPECT_EQ(8, test->Size());
+
+  // delete test
+  EXPECT_EQ(1, test->Remove(8));
+  EXPECT_EQ(1, test->Remove(4));
+  EXPECT_EQ(1, test->Remove(1));
+  EXPECT_EQ(0, test->Remove(20));
+  EXPECT_EQ(5, test->Size());
+  for (int i = 1; i <= 8; ++i) {
+    EXPECT_EQ(i != 1 && i != 4 && i != 8, test->Find(i, result));
+  }
+
+  delete test;
+}
+
+TEST(PageTableTest, CollisionTest) {
+  // keys a multiple of the capacity apart share long probe chains
+  const int num_keys = 32;
+  PageTable<int> test(num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    test.Insert(i * 64, i);
+  }
+  // remove every other key, the rest must stay reachable after the shifts
+  int result;
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_EQ(1, test.Remove(i * 64));
+  }
+  for (int i = 0; i < num_keys; ++i) {
+    EXPECT_EQ(i % 2 == 1, test.Find(i * 64, result));
+    if (i % 2 == 1) {
+      EXPECT_EQ(i, result);
+    }
+  }
+}
+
+TEST(PageTableTest, ConcurrentTest) {
+  // a writer keeps swapping keys in and out while readers look up keys that
+  // are always present
+  const int num_stable = 64;
+  const int num_readers = 3;
+  PageTable<int> test(2 * num_stable);
+  for (int i = 0; i < num_stable; ++i) {
+    test.Insert(i, i);
+  }
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] {
+    for (int round = 0; round < 2000; ++round) {
+      for (int i = 0; i < num_stable; ++i) {
+        test.Insert(num_stable + i, round);
+      }
+      for (int i = 0; i < num_stable; ++i) {
+        test.Remove(num_stable + i);
+      }
+    }
+    done = true;
+  });
+  for (int t = 0; t < num_readers; ++t) {
+    threads.emplace_back([&] {
+      int result;
+      while (!done) {
+        for (int i = 0; i < num_stable; ++i) {
+          EXPECT_EQ(1, test.Find(i, result));
+          EXPECT_EQ(i, result);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(num_stable, test.Size());
+}
+
+TEST(PageTableTest, ChurnTest) {
+  // several writers keep inserting and removing keys, shifting entries back
+  // across the slots readers probe; a key found always comes with its own
+  // value, and the keys that are never removed are always found
+  const int num_keys = 256;
+  const int num_writers = 2;
+  const int num_readers = 4;
+  PageTable<int> test(2 * num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    test.Insert(i, i);
+  }
+
+  std::atomic<int> num_done(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 1000; ++round) {
+        for (int i = num_keys + t; i < 2 * num_keys; i += num_writers) {
+          test.Insert(i, i + round * 2 * num_keys);
+        }
+        for (int i = num_keys + t; i < 2 * num_keys; i += num_writers) {
+          EXPECT_EQ(1, test.Remove(i));
+        }
+      }
+      num_done++;
+    });
+  }
+  std::atomic<size_t> num_lookups(0);
+  for (int t = 0; t < num_readers; ++t) {
+    threads.emplace_back([&] {
+      int result;
+      size_t lookups = 0;
+      while (num_done < num_writers) {
+        for (int i = 0; i < 2 * num_keys; ++i, ++lookups) {
+          bool found = test.Find(i, result);
+          if (i < num_keys) {
+            EXPECT_EQ(1, found);
+          }
+          if (found) {
+            EXPECT_EQ(i, result % (2 * num_keys));
+          }
+        }
+      }
+      num_lookups += lookups;
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(num_keys, test.Size());
+  EXPECT_LT(0, num_lookups);
+}
+
+/*
+ * Lookups per second on a table holding a buffer pool's worth of pages, with
+ * every thread hitting it at once (the FetchPage hit path)
+ */
+static double LookupsPerSecond(HashTable<page_id_t, int> *table,
+                               int num_threads) {
+  const int num_keys = 1024;
+  const int lookups_per_thread = 1 << 20;
+  for (int i = 0; i < num_keys; ++i) {
+    table->Insert(i, i);
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      int result;
+      for (int i = 0; i < lookups_per_thread; ++i) {
+        table->Find((i * 7 + t) % num_keys, result);
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return num_threads * lookups_per_thread / elapsed.count();
+}
+
+TEST(PageTableTest, LookupBenchmark) {
+  printf("lookups/s     ExtendibleHash    PageTable\n");
+  for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+    ExtendibleHash<page_id_t, int> extendible_hash(BUCKET_SIZE);
+    PageTable<int> page_table(1024);
+    double extendible = LookupsPerSecond(&extendible_hash, num_threads);
+    double lock_free = LookupsPerSecond(&page_table, num_threads);
+    printf("%d thread(s)   %14.0f %12.0f\n", num_threads, extendible,
+           lock_free);
+  }
+}
+
+} // namespace scudb
@@ -12,6 +12,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
 #include "index/b_plus_tree.h"
+#include "page/header_page.h"
 #include "vtable/virtual_table.h"
 #include "gtest/gtest.h"
 
@@ -100,6 +101,23 @@ void DeleteHelperSplit(
   delete transaction;
 }
 
+// helper function to look keys up, every one must be found
+void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+                  const std::vector<int64_t> &keys, int rounds,
+                  __attribute__((unused)) uint64_t thread_itr = 0) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int i = 0; i < rounds; i++) {
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(true, tree.GetValue(index_key, rids));
+      ASSERT_EQ(1, rids.size());
+      EXPECT_EQ(key & 0xFFFFFFFF, rids[0].GetSlotNum());
+    }
+  }
+}
+
 TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
@@ -301,6 +319,105 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, ReadWriteTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+  // even keys are there before, odd keys are inserted meanwhile
+  std::vector<int64_t> keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    if (key % 2 == 0)
+      keys.push_back(key);
+    else
+      new_keys.push_back(key);
+  }
+  InsertHelper(tree, keys);
+
+  // readers descend without latching internal pages while leaves and
+  // internal pages split under them
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; i++)
+    threads.push_back(std::thread(LookupHelper, std::ref(tree), keys, 5, i));
+  threads.push_back(std::thread(InsertHelper, std::ref(tree), new_keys, 0));
+  for (auto &thread : threads)
+    thread.join();
+
+  keys.insert(keys.end(), new_keys.begin(), new_keys.end());
+  LookupHelper(tree, keys, 1);
+  // hot descents follow swizzled child references
+  EXPECT_LT(0, bpm->GetNumSwizzleHits());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, DeleteReadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+  // even keys stay, odd keys are removed meanwhile
+  std::vector<int64_t> keys;
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    if (key % 2 == 0)
+      keys.push_back(key);
+    else
+      remove_keys.push_back(key);
+  }
+  InsertHelper(tree, keys);
+  InsertHelper(tree, remove_keys);
+
+  // readers descend without latching internal pages while siblings and
+  // parents are coalesced and redistributed under them
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; i++)
+    threads.push_back(std::thread(LookupHelper, std::ref(tree), keys, 5, i));
+  for (int i = 0; i < 2; i++)
+    threads.push_back(std::thread(DeleteHelperSplit, std::ref(tree),
+                                  remove_keys, 2, i));
+  for (auto &thread : threads)
+    thread.join();
+
+  LookupHelper(tree, keys, 1);
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (auto key : remove_keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(false, tree.GetValue(index_key, rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
@@ -348,4 +465,42 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, PriorityTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = static_cast<HeaderPage *>(bpm->NewPage(page_id));
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 2000; key++)
+    keys.push_back(key);
+  LaunchParallelTest(2, InsertHelperSplit, std::ref(tree), keys, 2);
+  page_id_t root_page_id;
+  EXPECT_EQ(true, header_page->GetRootId("foo_pk", root_page_id));
+
+  // a scan of plain pages does not push the root out of the pool
+  for (int i = 0; i < 200; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+  size_t misses = bpm->GetNumMisses();
+  ASSERT_NE(nullptr, bpm->FetchPage(root_page_id));
+  bpm->UnpinPage(root_page_id, false);
+  EXPECT_EQ(misses, bpm->GetNumMisses());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace scudb
@@ -0,0 +1,69 @@
+/**
+ * b_plus_tree_page_size_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(BPlusTreePageSizeTest, HeightAndScanBenchmark) {
+  const int64_t num_keys = 100000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  int last_height = 0;
+
+  for (size_t page_size = MIN_PAGE_SIZE; page_size <= MAX_PAGE_SIZE;
+       page_size *= 2) {
+    DiskManager *disk_manager = new DiskManager("test.db", page_size);
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    page_id_t page_id;
+    auto header_page = static_cast<HeaderPage *>(bpm->NewPage(page_id));
+    header_page->Init();
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    Transaction *transaction = new Transaction(0);
+    GenericKey<8> index_key;
+    RID rid;
+    for (int64_t key = 1; key <= num_keys; key++) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    delete transaction;
+
+    // larger pages give a flatter tree and a faster full scan
+    int height = tree.GetHeight();
+    if (last_height != 0) {
+      EXPECT_LE(height, last_height);
+    }
+    last_height = height;
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t num_scanned = 0;
+    for (auto iterator = tree.Begin(); iterator.isEnd() == false; ++iterator)
+      num_scanned++;
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(num_keys, num_scanned);
+    std::cout << "page size " << page_size << ": height " << height << ", "
+              << static_cast<int64_t>(num_scanned / elapsed.count())
+              << " keys/s scanned" << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+} // namespace scudb
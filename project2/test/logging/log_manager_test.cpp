@@ -1,6 +1,7 @@
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <thread>
 
 #include "logging/common.h"
 #include "logging/log_recovery.h"
@@ -9,6 +10,38 @@
 
 namespace scudb {
 
+TEST(LogManagerTest, FlushThreadTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  // a forced flush advances the persistent LSN
+  LogRecord begin_record(0, INVALID_LSN, LogRecordType::BEGIN);
+  lsn_t lsn = log_manager.AppendLogRecord(begin_record);
+  EXPECT_EQ(0, lsn);
+  log_manager.ForceFlush(lsn);
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+  // so does the periodic one
+  LogRecord commit_record(0, lsn, LogRecordType::COMMIT);
+  lsn = log_manager.AppendLogRecord(commit_record);
+  for (int i = 0; i < 50 && log_manager.GetPersistentLSN() < lsn; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+  // no record has that LSN, there is nothing to wait for
+  log_manager.ForceFlush(lsn + 10);
+
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(ENABLE_LOGGING);
+  char buffer[40]; // the two records, 20 bytes each
+  EXPECT_TRUE(disk_manager.ReadLog(buffer, sizeof(buffer), 0));
+  EXPECT_EQ(20, *reinterpret_cast<int32_t *>(buffer));
+  EXPECT_EQ(1, *reinterpret_cast<lsn_t *>(buffer + 24));
+
+  remove("test.db");
+  remove("test.log");
+}
+
 TEST(LogManagerTest, BasicLogging) {
   StorageEngine *storage_engine = new StorageEngine("test.db");
 
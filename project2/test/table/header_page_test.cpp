@@ -1,12 +1,11 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "buffer/buffer_pool_manager.h"
 #include "page/header_page.h"
 #include "gtest/gtest.h"
 
-// NOTE: when you running this test, make sure page size(config.h) is at least
-// 4096
 namespace scudb {
 
 TEST(HeaderPageTest, UnitTest) {
@@ -55,4 +54,80 @@ TEST(HeaderPageTest, UnitTest) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(HeaderPageTest, PageSizeTest) {
+  // a database keeps the page size it was created with
+  {
+    DiskManager disk_manager("test.db", 16384);
+    BufferPoolManager buffer_pool_manager(10, &disk_manager);
+    EXPECT_EQ(16384, buffer_pool_manager.GetPageSize());
+    page_id_t header_page_id;
+    HeaderPage *page = static_cast<HeaderPage *>(
+        buffer_pool_manager.NewPage(header_page_id));
+    ASSERT_NE(nullptr, page);
+    page->Init();
+    // far more records than a 4K page could hold
+    for (int i = 0; i < 400; i++) {
+      EXPECT_EQ(true, page->InsertRecord(std::to_string(i), i + 1));
+    }
+    EXPECT_EQ(true, buffer_pool_manager.UnpinPage(header_page_id, true));
+    EXPECT_EQ(true, buffer_pool_manager.FlushPage(header_page_id));
+  }
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(16384, disk_manager.GetPageSize());
+    BufferPoolManager buffer_pool_manager(10, &disk_manager);
+    HeaderPage *page =
+        static_cast<HeaderPage *>(buffer_pool_manager.FetchPage(HEADER_PAGE_ID));
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(400, page->GetRecordCount());
+    page_id_t root_id;
+    EXPECT_EQ(true, page->GetRootId("399", root_id));
+    EXPECT_EQ(400, root_id);
+    EXPECT_EQ(true, buffer_pool_manager.UnpinPage(HEADER_PAGE_ID, false));
+  }
+  remove("test.db");
+  remove("test.log");
+
+  EXPECT_THROW(DiskManager("test.db", 1000), Exception);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(HeaderPageTest, OlderFormatTest) {
+  // the header page of an older version: record count first, 512 byte pages
+  {
+    char page[512] = {0};
+    int record_count = 1;
+    page_id_t root_id = 1;
+    memcpy(page, &record_count, sizeof(record_count));
+    strcpy(page + 4, "foo");
+    memcpy(page + 36, &root_id, sizeof(root_id));
+    FILE *file = fopen("test.db", "wb");
+    ASSERT_NE(nullptr, file);
+    fwrite(page, sizeof(page), 1, file);
+    fwrite(page, sizeof(page), 1, file);
+    fclose(file);
+  }
+  EXPECT_EQ(true, DiskManager("test.db").IsOlderFormat());
+  remove("test.db");
+
+  // a new database, and one with a header page of this version
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(false, disk_manager.IsOlderFormat());
+    BufferPoolManager buffer_pool_manager(10, &disk_manager);
+    page_id_t header_page_id;
+    HeaderPage *page = static_cast<HeaderPage *>(
+        buffer_pool_manager.NewPage(header_page_id));
+    ASSERT_NE(nullptr, page);
+    page->Init();
+    EXPECT_EQ(true, page->InsertRecord("foo", 1));
+    EXPECT_EQ(true, buffer_pool_manager.UnpinPage(header_page_id, true));
+    EXPECT_EQ(true, buffer_pool_manager.FlushPage(header_page_id));
+  }
+  EXPECT_EQ(false, DiskManager("test.db").IsOlderFormat());
+  remove("test.db");
+  remove("test.log");
+}
 } // namespace scudb
@@ -47,6 +47,32 @@ TEST(TupleTest, TableHeapTest) {
     ++itr;
   }
 
+  // the heap is larger than the pool, scan it through a strategy ring
+  EXPECT_LT(50, table->GetNumPages());
+  int num_tuples = 0;
+  for (itr = table->begin(transaction, true); itr != table->end(); ++itr)
+    num_tuples++;
+  EXPECT_EQ(5000, num_tuples);
+
+  // reopened, the heap does not know its size: the scan switches to a ring
+  // once it is large, a page another query uses stays in the pool
+  TableHeap *reopened = new TableHeap(buffer_pool_manager, lock_manager,
+                                      log_manager, table->GetFirstPageId());
+  EXPECT_EQ(0, reopened->GetNumPages());
+  page_id_t hot_page_id;
+  ASSERT_NE(nullptr, buffer_pool_manager->NewPage(hot_page_id));
+  EXPECT_EQ(true, buffer_pool_manager->UnpinPage(hot_page_id, true));
+  num_tuples = 0;
+  for (itr = reopened->begin(transaction); itr != reopened->end(); ++itr)
+    num_tuples++;
+  EXPECT_EQ(5000, num_tuples);
+  EXPECT_EQ(table->GetNumPages(), reopened->GetNumPages());
+  size_t num_misses = buffer_pool_manager->GetNumMisses();
+  ASSERT_NE(nullptr, buffer_pool_manager->FetchPage(hot_page_id));
+  EXPECT_EQ(true, buffer_pool_manager->UnpinPage(hot_page_id, false));
+  EXPECT_EQ(num_misses, buffer_pool_manager->GetNumMisses());
+  delete reopened;
+
   // int i = 0;
   std::random_shuffle(rid_v.begin(), rid_v.end());
   for (auto rid : rid_v) {
@@ -61,4 +87,68 @@ TEST(TupleTest, TableHeapTest) {
   delete disk_manager;
 }
 
+// the pages of a table in the order of its page chain
+static std::vector<page_id_t> GetTablePages(TableHeap *table,
+                                            Transaction *txn) {
+  std::vector<page_id_t> pages;
+  for (auto itr = table->begin(txn); itr != table->end(); ++itr) {
+    if (pages.empty() || pages.back() != itr->GetRid().GetPageId())
+      pages.push_back(itr->GetRid().GetPageId());
+  }
+  return pages;
+}
+
+TEST(TupleTest, ExtentTest) {
+  Schema *schema = ParseCreateStatement("a varchar, b bigint");
+  Tuple tuple = ConstructTuple(schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table1 = new TableHeap(buffer_pool_manager, lock_manager,
+                                    log_manager, transaction);
+  TableHeap *table2 = new TableHeap(buffer_pool_manager, lock_manager,
+                                    log_manager, transaction);
+
+  // the tables grow at the same time, each one's pages still follow each
+  // other in the file
+  RID rid;
+  for (int i = 0; i < 2000; ++i) {
+    EXPECT_TRUE(table1->InsertTuple(tuple, rid, transaction));
+    EXPECT_TRUE(table2->InsertTuple(tuple, rid, transaction));
+  }
+  std::vector<page_id_t> pages1 = GetTablePages(table1, transaction);
+  std::vector<page_id_t> pages2 = GetTablePages(table2, transaction);
+  EXPECT_LT(1, pages1.size());
+  EXPECT_GT(EXTENT_PAGES, pages1.size());
+  EXPECT_EQ(pages1.size(), table1->GetNumPages());
+  EXPECT_EQ(pages2.size(), table2->GetNumPages());
+  for (size_t i = 0; i < pages1.size(); ++i)
+    EXPECT_EQ(static_cast<page_id_t>(i), pages1[i]);
+  for (size_t i = 0; i < pages2.size(); ++i)
+    EXPECT_EQ(static_cast<page_id_t>(EXTENT_PAGES + i), pages2[i]);
+
+  // the unused rest of the first run is free again, the one of the last is
+  // not used
+  table1->ReleaseExtent();
+  table2->ReleaseExtent();
+  EXPECT_EQ(EXTENT_PAGES - pages1.size(), disk_manager->GetNumFreePages());
+  EXPECT_EQ(static_cast<page_id_t>(EXTENT_PAGES + pages2.size()),
+            disk_manager->GetNextPageId());
+
+  remove("test.db");
+  remove("test.log");
+  delete schema;
+  delete table1;
+  delete table2;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete transaction;
+}
+
 } // namespace scudb